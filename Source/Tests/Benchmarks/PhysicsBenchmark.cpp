@@ -0,0 +1,199 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Headless physics benchmark on the scene of 12_PhysicsStressTest sample.
+// Simulates the same scene with single-threaded and multithreaded PhysicsWorld and reports step time percentiles.
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/PrefabReference.h>
+#include <Urho3D/Scene/PrefabResource.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace
+{
+
+struct BenchmarkConfig
+{
+    unsigned numObjects_{1000};
+    unsigned numMushrooms_{50};
+    float duration_{10.0f};
+    unsigned fps_{60};
+    std::string mode_{"all"};
+};
+
+BenchmarkConfig config;
+
+struct BenchmarkMode
+{
+    const char* name_{};
+    bool multithreaded_{};
+    bool deterministic_{};
+};
+
+double GetPercentile(const ea::vector<double>& sortedValues, double percentile)
+{
+    if (sortedValues.empty())
+        return 0.0;
+
+    const auto index = static_cast<unsigned>(percentile * (sortedValues.size() - 1));
+    return sortedValues[ea::min<unsigned>(index, sortedValues.size() - 1)];
+}
+
+/// Create the same physics content as 12_PhysicsStressTest sample.
+SharedPtr<Scene> CreateStressTestScene(Context* context, const BenchmarkMode& mode)
+{
+    auto cache = context->GetSubsystem<ResourceCache>();
+
+    const PhysicsWorldConfig oldConfig = PhysicsWorld::config;
+    PhysicsWorld::config.multithreaded_ = mode.multithreaded_;
+    PhysicsWorld::config.deterministic_ = mode.deterministic_;
+
+    auto scene = MakeShared<Scene>(context);
+    scene->CreateComponent<PhysicsWorld>();
+    PhysicsWorld::config = oldConfig;
+
+    // Use fixed seed so all modes simulate the same scene
+    SetRandomSeed(1);
+
+    {
+        Node* floorNode = scene->CreateChild("Floor");
+        floorNode->SetPosition(Vector3(0.0f, -0.5f, 0.0f));
+        floorNode->SetScale(Vector3(500.0f, 1.0f, 500.0f));
+        floorNode->CreateComponent<RigidBody>();
+        auto* shape = floorNode->CreateComponent<CollisionShape>();
+        shape->SetBox(Vector3::ONE);
+    }
+
+    {
+        auto* mushroomPrefab = cache->GetResource<PrefabResource>("Prefabs/Mushroom.prefab");
+        for (unsigned i = 0; i < config.numMushrooms_; ++i)
+        {
+            Node* mushroomNode = scene->CreateChild("Mushroom");
+            mushroomNode->SetPosition(Vector3(Random(400.0f) - 200.0f, 0.0f, Random(400.0f) - 200.0f));
+            mushroomNode->SetRotation(Quaternion(0.0f, Random(360.0f), 0.0f));
+            mushroomNode->SetScale(5.0f + Random(5.0f));
+            auto* prefabReference = mushroomNode->CreateComponent<PrefabReference>();
+            prefabReference->SetPrefab(mushroomPrefab);
+        }
+    }
+
+    for (unsigned i = 0; i < config.numObjects_; ++i)
+    {
+        Node* boxNode = scene->CreateChild("Box");
+        boxNode->SetPosition(Vector3(0.0f, i * 2.0f + 100.0f, 0.0f));
+        auto* body = boxNode->CreateComponent<RigidBody>();
+        body->SetMass(1.0f);
+        body->SetFriction(1.0f);
+        body->SetCollisionEventMode(COLLISION_NEVER);
+        auto* shape = boxNode->CreateComponent<CollisionShape>();
+        shape->SetBox(Vector3::ONE);
+    }
+
+    return scene;
+}
+
+}
+
+TEST_CASE("Physics stress test")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto workQueue = context->GetSubsystem<WorkQueue>();
+
+    const BenchmarkMode modes[] = {
+        {"single", false, false},
+        {"mt", true, false},
+        {"mt-deterministic", true, true},
+    };
+
+    PrintLine(Format("Physics benchmark: {} objects, {} mushrooms, {} s at {} fps, {} threads",
+        config.numObjects_, config.numMushrooms_, config.duration_, config.fps_, workQueue->GetNumProcessingThreads()));
+
+    double singleThreadedTime = 0.0;
+    for (const BenchmarkMode& mode : modes)
+    {
+        if (config.mode_ != "all" && config.mode_ != mode.name_)
+            continue;
+
+        auto scene = CreateStressTestScene(context, mode);
+        auto physicsWorld = scene->GetComponent<PhysicsWorld>();
+        physicsWorld->SetFps(config.fps_);
+
+        const float timeStep = 1.0f / config.fps_;
+        const unsigned numFrames = ea::max(1, RoundToInt(config.duration_ * config.fps_));
+
+        ea::vector<double> stepTimes;
+        double totalTime = 0.0;
+        HiresTimer timer;
+        for (unsigned frameIndex = 0; frameIndex < numFrames; ++frameIndex)
+        {
+            timer.Reset();
+            physicsWorld->Update(timeStep);
+            const double stepTime = timer.GetUSec(false) / 1000.0;
+            stepTimes.push_back(stepTime);
+            totalTime += stepTime;
+        }
+
+        if (!mode.multithreaded_)
+            singleThreadedTime = totalTime;
+
+        ea::sort(stepTimes.begin(), stepTimes.end());
+        PrintLine(Format("{}: step, ms: mean {:.3f}, p50 {:.3f}, p90 {:.3f}, p99 {:.3f}, max {:.3f}{}", mode.name_,
+            totalTime / numFrames, GetPercentile(stepTimes, 0.5), GetPercentile(stepTimes, 0.9),
+            GetPercentile(stepTimes, 0.99), stepTimes.back(),
+            singleThreadedTime > 0.0 && mode.multithreaded_
+                ? Format(" (speedup {:.2f}x)", singleThreadedTime / ea::max(totalTime, 0.001))
+                : EMPTY_STRING));
+
+        // Boxes should land on the floor
+        CHECK(scene->GetChild("Box")->GetWorldPosition().y_ > 0.0f);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    using namespace Catch::Clara;
+
+    Catch::Session session;
+    auto cli = session.cli()
+        | Opt(config.numObjects_, "count")["--objects"]("Number of falling boxes")
+        | Opt(config.numMushrooms_, "count")["--mushrooms"]("Number of static triangle mesh objects")
+        | Opt(config.duration_, "seconds")["--duration"]("Duration of simulation")
+        | Opt(config.fps_, "fps")["--fps"]("Physics steps per second")
+        | Opt(config.mode_, "all|single|mt|mt-deterministic")["--mode"]("Simulation mode");
+    session.cli(cli);
+
+    const int returnCode = session.applyCommandLine(argc, argv);
+    if (returnCode != 0)
+        return returnCode;
+
+    const int result = session.run();
+    Tests::ResetContext();
+    return result;
+}
@@ -0,0 +1,352 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Headless replication load test.
+// Runs one server scene and many simulated clients in one process and reports:
+// - server network tick time percentiles;
+// - server traffic per client per second;
+// - client join time and snapshot compression ratio;
+// - client-side interpolation error against analytic server trajectory.
+
+#include "../CommonUtils.h"
+#include "../NetworkUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/Core/CoreEvents.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Network/NetworkEvents.h>
+#include <Urho3D/Replica/BehaviorNetworkObject.h>
+#include <Urho3D/Replica/ClientReplica.h>
+#include <Urho3D/Replica/NetworkSettingsConsts.h>
+#include <Urho3D/Replica/ReplicatedTransform.h>
+#include <Urho3D/Replica/ReplicationManager.h>
+#include <Urho3D/Replica/ServerReplicator.h>
+#include <Urho3D/Scene/PrefabResource.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace
+{
+
+enum class MovementPattern
+{
+    Static,
+    Linear,
+    Circle,
+    Wander
+};
+
+struct BenchmarkConfig
+{
+    unsigned numClients_{16};
+    unsigned numObjects_{100};
+    float duration_{10.0f};
+    float warmup_{5.0f};
+    std::string movement_{"circle"};
+    float worldSize_{50.0f};
+    float speed_{5.0f};
+    float minPing_{0.08f};
+    float maxPing_{0.12f};
+    float dropRate_{0.02f};
+    unsigned budget_{};
+    unsigned snapshotBudget_{};
+    bool noSnapshotCompression_{};
+};
+
+BenchmarkConfig config;
+
+MovementPattern GetMovementPattern(const std::string& name)
+{
+    if (name == "static")
+        return MovementPattern::Static;
+    else if (name == "linear")
+        return MovementPattern::Linear;
+    else if (name == "wander")
+        return MovementPattern::Wander;
+    else
+        return MovementPattern::Circle;
+}
+
+/// Return position of the object at given time. Trajectory is analytic so the error can be evaluated at any time.
+Vector3 GetObjectPosition(MovementPattern pattern, unsigned index, float time)
+{
+    RandomEngine random{index};
+    const float halfSize = config.worldSize_ * 0.5f;
+    const Vector3 origin{random.GetFloat(-halfSize, halfSize), 0.0f, random.GetFloat(-halfSize, halfSize)};
+    const float phase = random.GetFloat(0.0f, 360.0f);
+    const float speed = config.speed_;
+
+    switch (pattern)
+    {
+    case MovementPattern::Linear:
+    {
+        // Move back and forth along X axis
+        const float range = 10.0f;
+        const float offset = Mod(time * speed + phase, 2.0f * range);
+        return origin + Vector3::RIGHT * (offset < range ? offset : 2.0f * range - offset);
+    }
+
+    case MovementPattern::Circle:
+    {
+        const float radius = 5.0f;
+        const float angle = time * speed / radius * M_RADTODEG + phase;
+        return origin + Vector3{Cos(angle), 0.0f, Sin(angle)} * radius;
+    }
+
+    case MovementPattern::Wander:
+    {
+        // Sum of incommensurable sines looks random but stays smooth
+        const float angle = time * speed * 10.0f + phase;
+        const Vector3 offset{Sin(angle) + 0.5f * Sin(angle * 2.3f), 0.0f, Cos(angle * 0.7f) + 0.5f * Sin(angle * 1.9f)};
+        return origin + offset * 4.0f;
+    }
+
+    case MovementPattern::Static:
+    default:
+        return origin;
+    }
+}
+
+double GetPercentile(const ea::vector<double>& sortedValues, double percentile)
+{
+    if (sortedValues.empty())
+        return 0.0;
+
+    const auto index = static_cast<unsigned>(percentile * (sortedValues.size() - 1));
+    return sortedValues[ea::min<unsigned>(index, sortedValues.size() - 1)];
+}
+
+SharedPtr<PrefabResource> CreateBenchmarkPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+    node->CreateComponent<ReplicatedTransform>();
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+}
+
+TEST_CASE("Replication load test")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto network = context->GetSubsystem<Network>();
+    network->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    const MovementPattern pattern = GetMovementPattern(config.movement_);
+    const unsigned updateFps = Tests::NetworkSimulator::FramesInSecond;
+    const float frameDuration = 1.0f / updateFps;
+
+    auto prefab = Tests::GetOrCreateResource<PrefabResource>(
+        context, "@/ReplicationBenchmark/Object.prefab", CreateBenchmarkPrefab);
+
+    // Measure server network update. Order of handlers of the same event is not guaranteed,
+    // so the timer is started at E_POSTUPDATE, which is always sent before E_RENDERUPDATE where Network sends
+    // E_NETWORKUPDATE. The server is done with the update when E_NETWORKUPDATESENT is sent.
+    // Other E_RENDERUPDATE handlers are included too, they do no work in headless scene.
+    auto serverScene = MakeShared<Scene>(context);
+    HiresTimer tickTimer;
+    bool isMeasuring = false;
+    ea::vector<double> tickTimes;
+    serverScene->SubscribeToEvent(E_POSTUPDATE, [&](VariantMap& eventData) { tickTimer.Reset(); });
+    serverScene->SubscribeToEvent(network, E_NETWORKUPDATESENT, [&](VariantMap& eventData)
+    {
+        if (isMeasuring && eventData[NetworkUpdate::P_ISSERVER].GetBool())
+            tickTimes.push_back(tickTimer.GetUSec(false) / 1000.0);
+    });
+
+    Tests::NetworkSimulator sim(serverScene);
+    auto serverReplicator = serverScene->GetComponent<ReplicationManager>()->GetServerReplicator();
+    serverReplicator->SetSetting(NetworkSettings::UnreliableUpdateBudget, config.budget_);
+    serverReplicator->SetSetting(NetworkSettings::SnapshotBudget, config.snapshotBudget_);
+    serverReplicator->SetSetting(NetworkSettings::SnapshotCompression, !config.noSnapshotCompression_);
+
+    // Spawn objects and move them at the beginning of each server frame
+    ea::vector<WeakPtr<Node>> serverNodes;
+    ea::unordered_map<NetworkId, unsigned> objectIndices;
+    for (unsigned i = 0; i < config.numObjects_; ++i)
+    {
+        Node* node = Tests::SpawnOnServer<BehaviorNetworkObject>(
+            serverScene, prefab, Format("Object {}", i), GetObjectPosition(pattern, i, 0.0f));
+        serverNodes.emplace_back(node);
+        objectIndices[node->GetComponent<BehaviorNetworkObject>()->GetNetworkId()] = i;
+    }
+
+    serverScene->SubscribeToEvent(E_BEGINSERVERNETWORKFRAME, [&](VariantMap& eventData)
+    {
+        const auto frame = eventData[BeginServerNetworkFrame::P_FRAME].GetInt64();
+        const float time = static_cast<float>(frame) / updateFps;
+        for (unsigned i = 0; i < serverNodes.size(); ++i)
+            serverNodes[i]->SetWorldPosition(GetObjectPosition(pattern, i, time));
+    });
+
+    // Connect clients
+    const Tests::ConnectionQuality quality{config.minPing_, config.maxPing_, config.maxPing_, config.dropRate_, 0.0f};
+    ea::vector<SharedPtr<Scene>> clientScenes;
+    for (unsigned i = 0; i < config.numClients_; ++i)
+    {
+        clientScenes.push_back(MakeShared<Scene>(context));
+        sim.AddClient(clientScenes.back(), quality);
+    }
+
+    const auto getTotalBytesSent = [&]
+    {
+        unsigned long long result = 0;
+        for (Scene* clientScene : clientScenes)
+            result += static_cast<Tests::ManualConnection*>(sim.GetServerToClientConnection(clientScene))->GetNumBytesSent();
+        return result;
+    };
+
+    // Warm up and measure time until each client receives all objects
+    ea::vector<double> joinTimes;
+    ea::vector<bool> isJoined(clientScenes.size());
+    const unsigned numWarmupFrames = ea::max(1, RoundToInt(config.warmup_ * updateFps));
+    for (unsigned frameIndex = 0; frameIndex < numWarmupFrames; ++frameIndex)
+    {
+        sim.SimulateTime(frameDuration);
+
+        for (unsigned i = 0; i < clientScenes.size(); ++i)
+        {
+            ClientReplica* replica = clientScenes[i]->GetComponent<ReplicationManager>()->GetClientReplica();
+            if (!isJoined[i] && replica && replica->GetNumReceivedSnapshots() >= config.numObjects_)
+            {
+                isJoined[i] = true;
+                joinTimes.push_back((frameIndex + 1) * frameDuration);
+            }
+        }
+    }
+
+    ClientSnapshotStats snapshotStats;
+    for (Scene* clientScene : clientScenes)
+    {
+        const ClientSnapshotStats stats = serverReplicator->GetSnapshotStats(sim.GetServerToClientConnection(clientScene));
+        snapshotStats.numSnapshotsSent_ += stats.numSnapshotsSent_;
+        snapshotStats.numRawBytes_ += stats.numRawBytes_;
+        snapshotStats.numCompressedBytes_ += stats.numCompressedBytes_;
+    }
+
+    // Measure
+    isMeasuring = true;
+    const unsigned long long bytesBefore = getTotalBytesSent();
+    const unsigned numFrames = ea::max(1, RoundToInt(config.duration_ * updateFps));
+
+    ea::vector<double> errors;
+    unsigned numMissingObjects = 0;
+    for (unsigned frameIndex = 0; frameIndex < numFrames; ++frameIndex)
+    {
+        sim.SimulateTime(frameDuration);
+
+        for (Scene* clientScene : clientScenes)
+        {
+            auto replicationManager = clientScene->GetComponent<ReplicationManager>();
+            ClientReplica* replica = replicationManager->GetClientReplica();
+            if (!replica)
+            {
+                numMissingObjects += config.numObjects_;
+                continue;
+            }
+
+            const NetworkTime replicaTime = replica->GetReplicaTime();
+            const float time = (static_cast<float>(replicaTime.Frame()) + replicaTime.Fraction()) / updateFps;
+
+            unsigned numFoundObjects = 0;
+            for (NetworkObject* networkObject : replicationManager->GetNetworkObjects())
+            {
+                const auto iter = objectIndices.find(networkObject->GetNetworkId());
+                if (iter == objectIndices.end())
+                    continue;
+
+                const Vector3 expectedPosition = GetObjectPosition(pattern, iter->second, time);
+                errors.push_back((networkObject->GetNode()->GetWorldPosition() - expectedPosition).Length());
+                ++numFoundObjects;
+            }
+            numMissingObjects += config.numObjects_ - numFoundObjects;
+        }
+    }
+
+    isMeasuring = false;
+    const unsigned long long bytesAfter = getTotalBytesSent();
+
+    // Report
+    ea::sort(tickTimes.begin(), tickTimes.end());
+    ea::sort(errors.begin(), errors.end());
+    ea::sort(joinTimes.begin(), joinTimes.end());
+
+    double meanError = 0.0;
+    for (double error : errors)
+        meanError += error;
+    meanError /= ea::max<size_t>(1, errors.size());
+
+    const double measuredDuration = numFrames * frameDuration;
+    const double bytesPerClientPerSecond =
+        (bytesAfter - bytesBefore) / ea::max(1.0, static_cast<double>(config.numClients_)) / measuredDuration;
+
+    PrintLine(Format("Replication benchmark: {} clients, {} objects, '{}' movement, ping {}-{} ms, loss {}%",
+        config.numClients_, config.numObjects_, config.movement_.c_str(), RoundToInt(config.minPing_ * 1000),
+        RoundToInt(config.maxPing_ * 1000), config.dropRate_ * 100.0f));
+    PrintLine(Format("Server tick, ms: p50 {:.3f}, p90 {:.3f}, p99 {:.3f}, max {:.3f} ({} ticks)",
+        GetPercentile(tickTimes, 0.5), GetPercentile(tickTimes, 0.9), GetPercentile(tickTimes, 0.99),
+        tickTimes.empty() ? 0.0 : tickTimes.back(), tickTimes.size()));
+    PrintLine(Format("Server traffic: {:.1f} bytes per client per second", bytesPerClientPerSecond));
+    PrintLine(Format("Join time, s: p50 {:.3f}, max {:.3f} ({} of {} clients joined during warmup)",
+        GetPercentile(joinTimes, 0.5), joinTimes.empty() ? 0.0 : joinTimes.back(), joinTimes.size(), clientScenes.size()));
+    PrintLine(Format("Snapshots: {} sent, {} bytes raw, {} bytes compressed (ratio {:.3f})",
+        snapshotStats.numSnapshotsSent_, snapshotStats.numRawBytes_, snapshotStats.numCompressedBytes_,
+        snapshotStats.numRawBytes_ != 0
+            ? static_cast<double>(snapshotStats.numCompressedBytes_) / snapshotStats.numRawBytes_
+            : 1.0));
+    PrintLine(Format("Interpolation error: mean {:.4f}, p50 {:.4f}, p99 {:.4f}, max {:.4f} ({} samples, {} missing)",
+        meanError, GetPercentile(errors, 0.5), GetPercentile(errors, 0.99), errors.empty() ? 0.0 : errors.back(),
+        errors.size(), numMissingObjects));
+
+    CHECK(numMissingObjects == 0);
+    CHECK(!tickTimes.empty());
+}
+
+int main(int argc, char* argv[])
+{
+    using namespace Catch::Clara;
+
+    Catch::Session session;
+    auto cli = session.cli()
+        | Opt(config.numClients_, "count")["--clients"]("Number of simulated clients")
+        | Opt(config.numObjects_, "count")["--objects"]("Number of replicated objects")
+        | Opt(config.duration_, "seconds")["--duration"]("Duration of measurement")
+        | Opt(config.warmup_, "seconds")["--warmup"]("Duration of simulation before measurement")
+        | Opt(config.movement_, "static|linear|circle|wander")["--movement"]("Movement pattern of objects")
+        | Opt(config.worldSize_, "size")["--world-size"]("Size of area where objects are spawned")
+        | Opt(config.speed_, "speed")["--speed"]("Speed of objects")
+        | Opt(config.minPing_, "seconds")["--min-ping"]("Min one-way latency")
+        | Opt(config.maxPing_, "seconds")["--max-ping"]("Max one-way latency")
+        | Opt(config.dropRate_, "ratio")["--loss"]("Ratio of dropped unreliable messages")
+        | Opt(config.budget_, "bytes")["--budget"]("Unreliable update budget per client per frame, 0 is unlimited")
+        | Opt(config.snapshotBudget_, "bytes")["--snapshot-budget"]("Snapshot budget per client per frame, 0 is unlimited")
+        | Opt(config.noSnapshotCompression_)["--no-snapshot-compression"]("Disable compression of snapshots");
+    session.cli(cli);
+
+    const int returnCode = session.applyCommandLine(argc, argv);
+    if (returnCode != 0)
+        return returnCode;
+
+    const int result = session.run();
+    Tests::ResetContext();
+    return result;
+}
@@ -0,0 +1,101 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/IO/BitStream.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+
+TEST_CASE("BitWriter and BitReader preserve raw bits")
+{
+    VectorBuffer buffer;
+    {
+        BitWriter dest{buffer};
+        dest.WriteBits(5, 3);
+        dest.WriteBool(true);
+        dest.WriteBits(0xabcdef, 24);
+        dest.WriteBits(0xffffffff, 32);
+        dest.WriteBool(false);
+        dest.WriteBits(1, 2);
+        REQUIRE(dest.GetNumBitsWritten() == 63);
+    }
+    REQUIRE(buffer.GetSize() == 8);
+
+    buffer.WriteUByte(42);
+
+    MemoryBuffer src{buffer.GetBuffer()};
+    {
+        BitReader bits{src};
+        REQUIRE(bits.ReadBits(3) == 5);
+        REQUIRE(bits.ReadBool() == true);
+        REQUIRE(bits.ReadBits(24) == 0xabcdef);
+        REQUIRE(bits.ReadBits(32) == 0xffffffff);
+        REQUIRE(bits.ReadBool() == false);
+        REQUIRE(bits.ReadBits(2) == 1);
+        REQUIRE_FALSE(bits.IsOverflow());
+    }
+    REQUIRE(src.ReadUByte() == 42);
+    REQUIRE(src.IsEof());
+}
+
+TEST_CASE("Floats are quantized within range")
+{
+    REQUIRE(DequantizeFloat(QuantizeFloat(0.0f, 10.0f, 12), 10.0f, 12) == 0.0f);
+    REQUIRE(DequantizeFloat(QuantizeFloat(10.0f, 10.0f, 12), 10.0f, 12) == 10.0f);
+    REQUIRE(DequantizeFloat(QuantizeFloat(-10.0f, 10.0f, 12), 10.0f, 12) == -10.0f);
+    REQUIRE(DequantizeFloat(QuantizeFloat(100.0f, 10.0f, 12), 10.0f, 12) == 10.0f);
+    REQUIRE(DequantizeFloat(QuantizeFloat(3.3f, 10.0f, 12), 10.0f, 12) == Catch::Approx(3.3f).margin(10.0f / 2047));
+}
+
+TEST_CASE("Vectors and quaternions are quantized")
+{
+    const Vector3 position{123.456f, -78.9f, 0.5f};
+    const Vector3 velocity{0.25f, 0.0f, -1.0f};
+    const Quaternion rotations[] = {
+        Quaternion::IDENTITY,
+        Quaternion{90.0f, Vector3::UP},
+        Quaternion{-179.0f, Vector3::RIGHT},
+        Quaternion{30.0f, 60.0f, -45.0f},
+        Quaternion{-0.5f, 0.5f, -0.5f, 0.5f},
+    };
+
+    VectorBuffer buffer;
+    {
+        BitWriter dest{buffer};
+        dest.WriteQuantizedVector3(position, 1024.0f, 20);
+        dest.WriteQuantizedVelocity(velocity, 4.0f, 12);
+        dest.WriteQuantizedVelocity(Vector3::ZERO, 4.0f, 12);
+        for (const Quaternion& rotation : rotations)
+            dest.WriteSmallestThreeQuaternion(rotation, 12);
+    }
+    REQUIRE(buffer.GetSize() == CeilToInt((60 + 37 + 1 + 5 * 38) / 8.0f));
+
+    MemoryBuffer src{buffer.GetBuffer()};
+    BitReader bits{src};
+    REQUIRE(bits.ReadQuantizedVector3(1024.0f, 20).Equals(position, 0.002f));
+    REQUIRE(bits.ReadQuantizedVelocity(4.0f, 12).Equals(velocity, 0.002f));
+    REQUIRE(bits.ReadQuantizedVelocity(4.0f, 12) == Vector3::ZERO);
+    for (const Quaternion& rotation : rotations)
+        REQUIRE(bits.ReadSmallestThreeQuaternion(12).Equivalent(rotation, 0.0001f));
+    REQUIRE_FALSE(bits.IsOverflow());
+}
@@ -185,5 +185,66 @@ TEST_CASE("Recast/Detour Crowdmanager test with DynamicNavigationMesh")
 
 }
 
+TEST_CASE("Navigation mesh tiles are rebuilt in worker threads")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    SetRandomSeed(1);
+
+    const bool isDynamic = GENERATE(false, true);
+    auto scene = CreateTestScene(context, 20);
+    scene->CreateComponent<Navigable>();
+
+    NavigationMesh* navMesh = isDynamic ? scene->CreateComponent<DynamicNavigationMesh>() : scene->CreateComponent<NavigationMesh>();
+    navMesh->SetTileSize(16);
+    navMesh->SetPadding(Vector3(0.0f, 10.0f, 0.0f));
+    REQUIRE(navMesh->Build());
+
+    const IntVector2 numTiles = navMesh->GetNumTiles();
+    REQUIRE(numTiles.x_ > 2);
+    REQUIRE(numTiles.y_ > 2);
+    for (int z = 0; z < numTiles.y_; ++z)
+    {
+        for (int x = 0; x < numTiles.x_; ++x)
+            REQUIRE(navMesh->HasTile(IntVector2(x, z)));
+    }
+
+    const Vector3 pointOnMesh = navMesh->FindNearestPoint(Vector3(-40.0f, 0.0f, 0.0f), Vector3(1.0f, 1.0f, 1.0f));
+    REQUIRE(pointOnMesh.Equals(Vector3(-40.0f, pointOnMesh.y_, 0.0f)));
+
+    // Rebuild whole mesh asynchronously
+    unsigned numRebuiltAreas = 0;
+    scene->SubscribeToEvent(navMesh, E_NAVIGATION_AREA_REBUILT, [&] { ++numRebuiltAreas; });
+
+    REQUIRE(navMesh->BuildAsync(navMesh->GetWorldBoundingBox()));
+    REQUIRE(navMesh->IsAsyncBuildInProgress());
+    REQUIRE(navMesh->GetAsyncBuildProgress() < 1.0f);
+
+    for (unsigned i = 0; i < 1000 && navMesh->IsAsyncBuildInProgress(); ++i)
+        Tests::RunFrame(context, 0.01f, 0.01f);
+
+    REQUIRE_FALSE(navMesh->IsAsyncBuildInProgress());
+    REQUIRE(navMesh->GetAsyncBuildProgress() == 1.0f);
+    REQUIRE(numRebuiltAreas > 0);
+    for (int z = 0; z < numTiles.y_; ++z)
+    {
+        for (int x = 0; x < numTiles.x_; ++x)
+            REQUIRE(navMesh->HasTile(IntVector2(x, z)));
+    }
+    REQUIRE(navMesh->FindNearestPoint(Vector3(-40.0f, 0.0f, 0.0f), Vector3(1.0f, 1.0f, 1.0f)).Equals(pointOnMesh));
+
+    // Cancelled build doesn't touch the mesh
+    REQUIRE(navMesh->BuildAsync(IntVector2::ZERO, numTiles - IntVector2::ONE));
+    navMesh->CancelAsyncBuild();
+    REQUIRE_FALSE(navMesh->IsAsyncBuildInProgress());
+    numRebuiltAreas = 0;
+    Tests::RunFrame(context, 0.01f, 0.1f);
+    REQUIRE(numRebuiltAreas == 0);
+
+    // Destroy mesh while the build is in progress
+    REQUIRE(navMesh->BuildAsync(IntVector2::ZERO, numTiles - IntVector2::ONE));
+    navMesh->Remove();
+    Tests::RunFrame(context, 0.01f, 0.1f);
+}
+
 #endif
 #endif
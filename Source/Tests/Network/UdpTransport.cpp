@@ -0,0 +1,153 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Network/UdpTransport.h>
+
+namespace
+{
+
+struct UdpTestPeer
+{
+    SharedPtr<UdpTransport> transport_;
+    ea::vector<ea::pair<NetworkMessageId, ByteVector>> receivedMessages_;
+    ea::vector<UdpConnection*> connections_;
+
+    explicit UdpTestPeer(Context* context)
+        : transport_(MakeShared<UdpTransport>(context))
+    {
+        transport_->OnConnected.Subscribe(transport_.Get(), [this](UdpConnection* connection)
+        {
+            connections_.push_back(connection);
+        });
+        transport_->OnMessage.Subscribe(transport_.Get(), [this](UdpConnection*, NetworkMessageId messageId, MemoryBuffer& data)
+        {
+            receivedMessages_.emplace_back(messageId, ByteVector(data.GetData(), data.GetData() + data.GetSize()));
+        });
+    }
+};
+
+template <class T>
+bool UpdateUntil(UdpTestPeer& server, UdpTestPeer& client, T condition, unsigned timeoutMs = 10000)
+{
+    Timer timer;
+    while (timer.GetMSec(false) < timeoutMs)
+    {
+        server.transport_->Update();
+        client.transport_->Update();
+        if (condition())
+            return true;
+        Time::Sleep(1);
+    }
+    return false;
+}
+
+ByteVector CreateMessageData(unsigned index, unsigned size)
+{
+    ByteVector data(size);
+    for (unsigned i = 0; i < size; ++i)
+        data[i] = static_cast<unsigned char>(index * 31 + i);
+    return data;
+}
+
+}
+
+TEST_CASE("UDP transport delivers reliable ordered messages despite packet loss")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    UdpTestPeer server(context);
+    UdpTestPeer client(context);
+    REQUIRE(server.transport_->Listen(0));
+    REQUIRE(client.transport_->Connect("127.0.0.1", server.transport_->GetLocalPort()));
+
+    REQUIRE(UpdateUntil(server, client, [&] { return !server.connections_.empty() && !client.connections_.empty(); }));
+
+    server.transport_->SetSimulatedPacketLoss(0.2f);
+    client.transport_->SetSimulatedPacketLoss(0.2f);
+
+    // Send small messages and messages that require fragmentation
+    const unsigned numMessages = 100;
+    const auto getMessageSize = [](unsigned index) { return index % 10 == 0 ? 5000 : 1 + index * 3; };
+    for (unsigned i = 0; i < numMessages; ++i)
+    {
+        const ByteVector data = CreateMessageData(i, getMessageSize(i));
+        server.connections_[0]->SendMessage(MSG_USER, true, true, data.data(), data.size());
+    }
+
+    REQUIRE(UpdateUntil(server, client, [&] { return client.receivedMessages_.size() >= numMessages; }));
+    REQUIRE(client.receivedMessages_.size() == numMessages);
+    for (unsigned i = 0; i < numMessages; ++i)
+    {
+        REQUIRE(client.receivedMessages_[i].first == MSG_USER);
+        REQUIRE(client.receivedMessages_[i].second == CreateMessageData(i, getMessageSize(i)));
+    }
+
+    // All messages are eventually acknowledged
+    REQUIRE(UpdateUntil(server, client, [&] { return server.connections_[0]->GetNumPendingReliableMessages() == 0; }));
+    REQUIRE(server.connections_[0]->GetNumMessagesResent() > 0);
+}
+
+TEST_CASE("UDP transport delivers unreliable ordered messages in order")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    UdpTestPeer server(context);
+    UdpTestPeer client(context);
+    REQUIRE(server.transport_->Listen(0));
+    REQUIRE(client.transport_->Connect("127.0.0.1", server.transport_->GetLocalPort()));
+
+    REQUIRE(UpdateUntil(server, client, [&] { return !server.connections_.empty() && !client.connections_.empty(); }));
+
+    server.transport_->SetSimulatedPacketLoss(0.3f);
+
+    // Send messages in separate datagrams so some of them are lost
+    const unsigned numMessages = 200;
+    for (unsigned i = 0; i < numMessages; ++i)
+    {
+        VectorBuffer data;
+        data.WriteUInt(i);
+        data.Write(CreateMessageData(i, 1000).data(), 1000);
+        client.connections_[0]->SendMessage(MSG_USER, false, true, data);
+        server.connections_[0]->SendMessage(MSG_USER, false, true, data);
+        server.transport_->Update();
+        client.transport_->Update();
+    }
+
+    UpdateUntil(server, client, [] { return false; }, 200);
+
+    // Client to server direction is lossless
+    REQUIRE(server.receivedMessages_.size() == numMessages);
+
+    REQUIRE(client.receivedMessages_.size() > 0);
+    REQUIRE(client.receivedMessages_.size() < numMessages);
+    ea::optional<unsigned> previousIndex;
+    for (const auto& [messageId, data] : client.receivedMessages_)
+    {
+        MemoryBuffer src(data);
+        const unsigned index = src.ReadUInt();
+        REQUIRE((!previousIndex || index > *previousIndex));
+        previousIndex = index;
+    }
+}
@@ -63,6 +63,7 @@ void ManualConnection::SendMessageInternal(NetworkMessageId messageId, bool reli
     const double currentShuffleRatio = shuffledMessages_ / ea::max(1.0, static_cast<double>(totalUnorderedMessages_));
 
     ++totalMessages_;
+    totalBytes_ += numBytes;
     if (!reliable)
         ++totalUnreliableMessages_;
     if (!inOrder)
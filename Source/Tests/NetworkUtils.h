@@ -74,6 +74,9 @@ public:
 
     void IncrementTime(unsigned delta);
 
+    /// Return total number of bytes sent, including dropped messages.
+    unsigned long long GetNumBytesSent() const { return totalBytes_; }
+
 private:
     struct InternalMessage
     {
@@ -97,6 +100,7 @@ private:
     ea::vector<InternalMessage> messages_[2][2];
 
     unsigned totalMessages_{};
+    unsigned long long totalBytes_{};
     unsigned totalUnorderedMessages_{};
     unsigned totalUnreliableMessages_{};
     unsigned droppedMessages_{};
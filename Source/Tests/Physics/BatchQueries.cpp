@@ -0,0 +1,116 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#include <Urho3D/Scene/Scene.h>
+
+TEST_CASE("Batched physics queries match single queries")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto scene = MakeShared<Scene>(context);
+    auto physicsWorld = scene->CreateComponent<PhysicsWorld>();
+
+    ea::vector<RigidBody*> bodies;
+    for (unsigned i = 0; i < 64; ++i)
+    {
+        Node* node = scene->CreateChild("Box");
+        node->SetPosition({(i % 8) * 3.0f, 0.0f, (i / 8) * 3.0f});
+        auto body = node->CreateComponent<RigidBody>();
+        body->SetCollisionLayer(i % 2 ? 1 : 2);
+        bodies.push_back(body);
+        node->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+    }
+    physicsWorld->Update(1.0f / 60.0f);
+
+    ea::vector<PhysicsRaycastQuery> rayQueries;
+    ea::vector<PhysicsSphereCastQuery> sphereQueries;
+    ea::vector<PhysicsOverlapQuery> overlapQueries;
+    for (unsigned i = 0; i < 100; ++i)
+    {
+        const Vector3 origin{i * 0.25f, 5.0f, (i % 13) * 1.7f};
+        const Ray ray{origin, Vector3{0.1f * (i % 3), -1.0f, 0.0f}.Normalized()};
+        const unsigned mask = i % 3 == 0 ? M_MAX_UNSIGNED : 1;
+        rayQueries.push_back({ray, 10.0f, mask});
+        sphereQueries.push_back({ray, 0.3f, 10.0f, mask});
+        overlapQueries.push_back({Sphere{Vector3{origin.x_, 0.0f, origin.z_}, 1.0f}, mask});
+    }
+
+    ea::vector<PhysicsRaycastResult> rayResults(rayQueries.size());
+    physicsWorld->RaycastSingleBatch(rayQueries, rayResults);
+
+    ea::vector<PhysicsRaycastResult> sphereResults(sphereQueries.size());
+    physicsWorld->SphereCastBatch(sphereQueries, sphereResults);
+
+    const unsigned maxOverlaps = 8;
+    ea::vector<RigidBody*> overlapResults(overlapQueries.size() * maxOverlaps);
+    ea::vector<unsigned> numOverlaps(overlapQueries.size());
+    physicsWorld->GetRigidBodiesBatch(overlapQueries, overlapResults, numOverlaps, maxOverlaps);
+
+    unsigned numHits = 0;
+    for (unsigned i = 0; i < rayQueries.size(); ++i)
+    {
+        PhysicsRaycastResult expectedRay;
+        physicsWorld->RaycastSingle(expectedRay, rayQueries[i].ray_, rayQueries[i].maxDistance_, rayQueries[i].collisionMask_);
+        REQUIRE(rayResults[i].body_ == expectedRay.body_);
+        if (expectedRay.body_)
+        {
+            ++numHits;
+            REQUIRE(rayResults[i].position_.Equals(expectedRay.position_, 0.001f));
+            REQUIRE(rayResults[i].distance_ == Catch::Approx(expectedRay.distance_).margin(0.001f));
+        }
+
+        PhysicsRaycastResult expectedSphere;
+        physicsWorld->SphereCast(expectedSphere, sphereQueries[i].ray_, sphereQueries[i].radius_,
+            sphereQueries[i].maxDistance_, sphereQueries[i].collisionMask_);
+        REQUIRE(sphereResults[i].body_ == expectedSphere.body_);
+        if (expectedSphere.body_)
+            REQUIRE(sphereResults[i].distance_ == Catch::Approx(expectedSphere.distance_).margin(0.001f));
+
+        // Contact test reports near contacts too, so overlaps are compared with boxes of known size instead.
+        // Batched overlaps test bounding boxes with collision margin, so they may report slightly distant bodies.
+        const Sphere& sphere = overlapQueries[i].sphere_;
+        const Sphere expandedSphere{sphere.center_, sphere.radius_ + 0.1f};
+        ea::vector<RigidBody*> actualBodies(&overlapResults[i * maxOverlaps], &overlapResults[i * maxOverlaps] + numOverlaps[i]);
+        for (RigidBody* body : bodies)
+        {
+            if (!(body->GetCollisionLayer() & overlapQueries[i].collisionMask_))
+            {
+                REQUIRE_FALSE(actualBodies.contains(body));
+                continue;
+            }
+
+            const Vector3 position = body->GetNode()->GetWorldPosition();
+            const BoundingBox boundingBox{position - Vector3::ONE * 0.5f, position + Vector3::ONE * 0.5f};
+            if (sphere.IsInside(boundingBox) != OUTSIDE)
+                REQUIRE(actualBodies.contains(body));
+            else if (expandedSphere.IsInside(boundingBox) == OUTSIDE)
+                REQUIRE_FALSE(actualBodies.contains(body));
+        }
+    }
+    REQUIRE(numHits > 0);
+}
@@ -0,0 +1,119 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Graphics/Model.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/CookedCollisionGeometry.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace
+{
+
+/// Cast rays down onto the model with triangle mesh shape and return hit positions.
+ea::vector<Vector3> CastRaysOnModel(Context* context, Model* model, CollisionGeometryData*& geometryData)
+{
+    auto scene = MakeShared<Scene>(context);
+    auto physicsWorld = scene->CreateComponent<PhysicsWorld>();
+
+    Node* node = scene->CreateChild("Model");
+    node->CreateComponent<RigidBody>();
+    auto shape = node->CreateComponent<CollisionShape>();
+    shape->SetTriangleMesh(model);
+    geometryData = shape->GetGeometryData();
+    physicsWorld->UpdateCollisions();
+
+    ea::vector<Vector3> hits;
+    const BoundingBox& boundingBox = model->GetBoundingBox();
+    for (unsigned i = 0; i <= 10; ++i)
+    {
+        for (unsigned j = 0; j <= 10; ++j)
+        {
+            const Vector3 origin{Lerp(boundingBox.min_.x_, boundingBox.max_.x_, i / 10.0f),
+                boundingBox.max_.y_ + 1.0f, Lerp(boundingBox.min_.z_, boundingBox.max_.z_, j / 10.0f)};
+            PhysicsRaycastResult result;
+            physicsWorld->RaycastSingle(result, Ray{origin, Vector3::DOWN}, 100.0f);
+            hits.push_back(result.body_ ? result.position_ : Vector3{M_INFINITY, M_INFINITY, M_INFINITY});
+        }
+    }
+    return hits;
+}
+
+}
+
+TEST_CASE("Cooked collision geometry is saved, loaded and used by collision shapes")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto cache = context->GetSubsystem<ResourceCache>();
+    auto model = cache->GetResource<Model>("Models/Mushroom.mdl");
+    REQUIRE(model);
+
+    // Cook and reload from memory
+    auto cookedGeometry = MakeShared<CookedCollisionGeometry>(context);
+    REQUIRE(cookedGeometry->CookGeometry(SHAPE_TRIANGLEMESH, model, 0));
+    REQUIRE(cookedGeometry->CookGeometry(SHAPE_CONVEXHULL, model, 0));
+
+    VectorBuffer buffer;
+    REQUIRE(cookedGeometry->Save(buffer));
+
+    auto loadedGeometry = MakeShared<CookedCollisionGeometry>(context);
+    MemoryBuffer source{buffer.GetBuffer()};
+    REQUIRE(loadedGeometry->Load(source));
+    REQUIRE(loadedGeometry->GetNumGeometries() == 2);
+
+    const CookedCollisionGeometryData* expectedMesh = cookedGeometry->GetCookedData(SHAPE_TRIANGLEMESH, 0);
+    const CookedCollisionGeometryData* loadedMesh = loadedGeometry->GetCookedData(SHAPE_TRIANGLEMESH, 0);
+    REQUIRE(loadedMesh);
+    REQUIRE(!loadedMesh->indices_.empty());
+    REQUIRE(loadedMesh->indices_ == expectedMesh->indices_);
+    REQUIRE(!loadedMesh->bvhData_.empty());
+    REQUIRE(loadedMesh->bvhData_ == expectedMesh->bvhData_);
+    REQUIRE(loadedMesh->triangleInfoKeys_ == expectedMesh->triangleInfoKeys_);
+
+    const CookedCollisionGeometryData* loadedHull = loadedGeometry->GetCookedData(SHAPE_CONVEXHULL, 0);
+    REQUIRE(loadedHull);
+    REQUIRE(!loadedHull->vertices_.empty());
+
+    // Collision shapes use cooked geometry once it's available
+    CollisionGeometryData* builtData{};
+    const auto expectedHits = CastRaysOnModel(context, model, builtData);
+
+    loadedGeometry->SetName(CookedCollisionGeometry::GetResourceName(model->GetName()));
+    cache->AddManualResource(loadedGeometry);
+
+    CollisionGeometryData* cookedData{};
+    const auto actualHits = CastRaysOnModel(context, model, cookedData);
+
+    cache->ReleaseResource<CookedCollisionGeometry>(loadedGeometry->GetName(), true);
+
+    REQUIRE(cookedData == loadedGeometry->GetGeometryData(SHAPE_TRIANGLEMESH, 0));
+    REQUIRE(actualHits.size() == expectedHits.size());
+    for (unsigned i = 0; i < actualHits.size(); ++i)
+        REQUIRE(actualHits[i].Equals(expectedHits[i], 0.001f));
+}
@@ -0,0 +1,129 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace
+{
+
+/// Simulate pile of boxes and return final positions.
+ea::vector<Vector3> SimulateBoxes(Context* context, bool multithreaded, bool deterministic)
+{
+    const PhysicsWorldConfig oldConfig = PhysicsWorld::config;
+    PhysicsWorld::config.multithreaded_ = multithreaded;
+    PhysicsWorld::config.deterministic_ = deterministic;
+
+    auto scene = MakeShared<Scene>(context);
+    auto physicsWorld = scene->CreateComponent<PhysicsWorld>();
+    PhysicsWorld::config = oldConfig;
+
+    Node* floorNode = scene->CreateChild("Floor");
+    floorNode->SetPosition({0.0f, -0.5f, 0.0f});
+    floorNode->SetScale({100.0f, 1.0f, 100.0f});
+    floorNode->CreateComponent<RigidBody>();
+    floorNode->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+
+    ea::vector<Node*> boxNodes;
+    for (unsigned i = 0; i < 100; ++i)
+    {
+        Node* boxNode = scene->CreateChild("Box");
+        boxNode->SetPosition({(i % 5) * 1.5f, 1.0f + (i / 5) * 1.5f, (i % 3) * 0.3f});
+        auto body = boxNode->CreateComponent<RigidBody>();
+        body->SetMass(1.0f);
+        body->SetFriction(1.0f);
+        boxNode->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+        boxNodes.push_back(boxNode);
+    }
+
+#ifdef URHO3D_THREADING
+    REQUIRE(physicsWorld->IsMultithreaded() == multithreaded);
+#endif
+
+    for (unsigned i = 0; i < 180; ++i)
+        physicsWorld->Update(1.0f / 60.0f);
+
+    ea::vector<Vector3> positions;
+    for (Node* boxNode : boxNodes)
+        positions.push_back(boxNode->GetWorldPosition());
+    return positions;
+}
+
+}
+
+TEST_CASE("Multithreaded physics world simulates the same scene as single-threaded world")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    const auto singleThreaded = SimulateBoxes(context, false, false);
+    const auto multithreaded = SimulateBoxes(context, true, false);
+
+    REQUIRE(singleThreaded.size() == multithreaded.size());
+    for (unsigned i = 0; i < multithreaded.size(); ++i)
+    {
+        // Boxes fall onto the floor and stay above it
+        REQUIRE(singleThreaded[i].y_ > 0.0f);
+        REQUIRE(multithreaded[i].y_ > 0.0f);
+        REQUIRE(multithreaded[i].y_ < 30.0f);
+    }
+}
+
+TEST_CASE("Deterministic multithreaded physics world is reproducible")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    const auto firstRun = SimulateBoxes(context, true, true);
+    const auto secondRun = SimulateBoxes(context, true, true);
+
+    REQUIRE(firstRun == secondRun);
+}
+
+TEST_CASE("Simulated transforms are applied to parented rigid bodies")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto scene = MakeShared<Scene>(context);
+    auto physicsWorld = scene->CreateComponent<PhysicsWorld>();
+
+    Node* parentNode = scene->CreateChild("Parent");
+    parentNode->SetPosition({0.0f, 10.0f, 0.0f});
+    parentNode->CreateComponent<RigidBody>()->SetMass(1.0f);
+    parentNode->CreateComponent<CollisionShape>()->SetSphere(1.0f);
+
+    Node* childNode = parentNode->CreateChild("Child");
+    childNode->SetPosition({5.0f, 0.0f, 0.0f});
+    childNode->CreateComponent<RigidBody>()->SetMass(1.0f);
+    childNode->CreateComponent<CollisionShape>()->SetSphere(1.0f);
+
+    for (unsigned i = 0; i < 30; ++i)
+        physicsWorld->Update(1.0f / 60.0f);
+
+    // Both bodies fall freely, so the child doesn't move relative to the parent
+    REQUIRE(parentNode->GetWorldPosition().y_ < 9.0f);
+    REQUIRE(childNode->GetWorldPosition().y_ == Catch::Approx(parentNode->GetWorldPosition().y_).margin(0.001f));
+    REQUIRE(childNode->GetPosition().Equals({5.0f, 0.0f, 0.0f}, 0.001f));
+}
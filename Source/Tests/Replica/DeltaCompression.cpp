@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+#include "../NetworkUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Replica/BehaviorNetworkObject.h>
+#include <Urho3D/Replica/ProtocolMessages.h>
+#include <Urho3D/Replica/ReplicatedTransform.h>
+#include <Urho3D/Replica/ReplicationManager.h>
+#include <Urho3D/Scene/PrefabResource.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneEvents.h>
+
+namespace
+{
+
+SharedPtr<PrefabResource> CreateTestPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+    node->CreateComponent<ReplicatedTransform>();
+
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+ByteVector EncodeAndDecode(const ByteVector& baseline, const ByteVector& data, unsigned& encodedSize)
+{
+    VectorBuffer delta;
+    EncodeDeltaUpdate(baseline, data, delta);
+    encodedSize = delta.GetSize();
+
+    ByteVector result;
+    REQUIRE(DecodeDeltaUpdate(baseline, delta.GetBuffer(), result));
+    return result;
+}
+
+}
+
+TEST_CASE("Delta updates are encoded and decoded")
+{
+    const ByteVector baseline{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    unsigned encodedSize{};
+
+    // Identical data is encoded in a few bytes
+    REQUIRE(EncodeAndDecode(baseline, baseline, encodedSize) == baseline);
+    REQUIRE(encodedSize < 4);
+
+    // Sparse changes are encoded compactly: two bytes of header and three bytes per changed byte
+    ByteVector changed = baseline;
+    changed[3] = 100;
+    changed[12] = 200;
+    REQUIRE(EncodeAndDecode(baseline, changed, encodedSize) == changed);
+    REQUIRE(encodedSize == 8);
+
+    // Data of different size is supported
+    const ByteVector shorter{1, 2, 3, 42};
+    REQUIRE(EncodeAndDecode(baseline, shorter, encodedSize) == shorter);
+
+    const ByteVector longer{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18};
+    REQUIRE(EncodeAndDecode(baseline, longer, encodedSize) == longer);
+
+    REQUIRE(EncodeAndDecode({}, changed, encodedSize) == changed);
+
+    // Malformed data is rejected
+    VectorBuffer delta;
+    EncodeDeltaUpdate(baseline, changed, delta);
+
+    ByteVector result;
+    const ByteVector truncatedDelta(delta.GetBuffer().begin(), delta.GetBuffer().end() - 1);
+    REQUIRE_FALSE(DecodeDeltaUpdate(baseline, truncatedDelta, result));
+    REQUIRE_FALSE(DecodeDeltaUpdate(shorter, delta.GetBuffer(), result));
+}
+
+TEST_CASE("Delta-compressed updates are synchronized over lossy connection")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto prefab = Tests::GetOrCreateResource<PrefabResource>(context, "@/DeltaCompression/Test.prefab", CreateTestPrefab);
+
+    // Setup scenes
+    const auto quality = Tests::ConnectionQuality{0.08f, 0.12f, 0.20f, 0.2f, 0.2f};
+
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientScene = MakeShared<Scene>(context);
+
+    const unsigned numNodes = 4;
+    ea::vector<Node*> serverNodes;
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        Node* serverNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, Format("Node {}", i));
+        serverNode->SetPosition(Vector3::FORWARD * static_cast<float>(i));
+        // Send updates every frame so most of them are delta-compressed
+        serverNode->GetComponent<ReplicatedTransform>()->SetNumUploadAttempts(0);
+        serverNodes.push_back(serverNode);
+    }
+
+    // Move objects for some time, then stop them
+    bool isMoving = true;
+    serverScene->SubscribeToEvent(serverScene, E_SCENEUPDATE,
+        [&](VariantMap& eventData)
+    {
+        if (!isMoving)
+            return;
+
+        const float timeStep = eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+        for (unsigned i = 0; i < numNodes; ++i)
+        {
+            serverNodes[i]->Translate(timeStep * static_cast<float>(i + 1) * Vector3::LEFT, TS_PARENT);
+            serverNodes[i]->Rotate({timeStep * 10.0f, Vector3::UP}, TS_PARENT);
+        }
+    });
+
+    Tests::NetworkSimulator sim(serverScene);
+    sim.SimulateTime(1.0f);
+
+    sim.AddClient(clientScene, quality);
+    sim.SimulateTime(5.0f);
+
+    isMoving = false;
+    sim.SimulateTime(3.0f);
+
+    // Expect final state to be delivered exactly
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        const ea::string name = Format("Node {}", i);
+        Node* serverNode = serverScene->GetChild(name, true);
+        Node* clientNode = clientScene->GetChild(name, true);
+        REQUIRE(clientNode);
+
+        REQUIRE(clientNode->GetWorldPosition().Equals(serverNode->GetWorldPosition(), M_LARGE_EPSILON));
+        REQUIRE(clientNode->GetWorldRotation().Equivalent(serverNode->GetWorldRotation(), M_LARGE_EPSILON));
+    }
+}
@@ -31,6 +31,7 @@
 #include <Urho3D/Scene/SceneEvents.h>
 #include <Urho3D/Replica/BehaviorNetworkObject.h>
 #include <Urho3D/Replica/FilteredByDistance.h>
+#include <Urho3D/Replica/NetworkSettingsConsts.h>
 #include <Urho3D/Replica/ReplicationManager.h>
 #include <Urho3D/Replica/ReplicatedTransform.h>
 
@@ -162,3 +163,55 @@ TEST_CASE("FilteredByDistance handles object hierarchies")
         REQUIRE_FALSE(unfilteredChildNode);
     }
 }
+
+TEST_CASE("FilteredByDistance reacts to objects entering and leaving interest area")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto filteredPrefab = Tests::GetOrCreateResource<PrefabResource>(context, "@/FilteredByDistance/FilteredTest.prefab", CreateFilteredTestPrefab);
+
+    // Create scenes and enable interest management
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientScene = MakeShared<Scene>(context);
+
+    const auto quality = Tests::ConnectionQuality{ 0.08f, 0.12f, 0.20f, 0.02f, 0.02f };
+    Tests::NetworkSimulator sim(serverScene);
+
+    auto serverReplicator = serverScene->GetComponent<ReplicationManager>()->GetServerReplicator();
+    serverReplicator->SetSetting(NetworkSettings::InterestCellSize, 4.0f);
+    serverReplicator->SetSetting(NetworkSettings::InterestRadius, 10.0f);
+
+    sim.AddClient(clientScene, quality);
+    sim.SimulateTime(5.0f);
+
+    // Spawn objects
+    {
+        auto clientNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, filteredPrefab, "Client Node");
+        clientNode->GetComponent<BehaviorNetworkObject>()->SetOwner(sim.GetServerToClientConnection(clientScene));
+        clientNode->SetWorldPosition(Vector3(0.0f, 0.0f, 0.0f));
+
+        auto nearNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, filteredPrefab, "Near Node");
+        nearNode->SetWorldPosition(Vector3(0.0f, 0.0f, 8.0f));
+
+        auto farNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, filteredPrefab, "Far Node");
+        farNode->SetWorldPosition(Vector3(-30.0f, 0.0f, 30.0f));
+    }
+
+    sim.SimulateTime(2.0f);
+    REQUIRE(serverScene->GetComponent<ReplicationManager>()->HasSpatialIndex());
+
+    REQUIRE(clientScene->GetChild("Client Node", true));
+    REQUIRE(clientScene->GetChild("Near Node", true));
+    REQUIRE_FALSE(clientScene->GetChild("Far Node", true));
+
+    // Move objects across the border of interest area, expect changes faster than relevance timeout
+    serverScene->GetChild("Near Node", true)->SetWorldPosition(Vector3{0.0f, 0.0f, -12.0f});
+    serverScene->GetChild("Far Node", true)->SetWorldPosition(Vector3{-6.0f, 0.0f, 6.0f});
+    sim.SimulateTime(1.0f);
+
+    REQUIRE(clientScene->GetChild("Client Node", true));
+    REQUIRE_FALSE(clientScene->GetChild("Near Node", true));
+    REQUIRE(clientScene->GetChild("Far Node", true));
+    REQUIRE(clientScene->GetChild("Far Node", true)->GetWorldPosition() == Vector3{-6.0f, 0.0f, 6.0f});
+}
@@ -36,6 +36,7 @@
 #include <Urho3D/Replica/BehaviorNetworkObject.h>
 #include <Urho3D/Replica/ReplicationManager.h>
 #include <Urho3D/Replica/NetworkObject.h>
+#include <Urho3D/Replica/NetworkSettingsConsts.h>
 #include <Urho3D/Replica/NetworkValue.h>
 #include <Urho3D/Replica/ReplicatedTransform.h>
 
@@ -371,6 +372,53 @@ TEST_CASE("Position and rotation are synchronized between client and server")
     }
 }
 
+TEST_CASE("Quantized position and rotation are synchronized between client and server")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto prefab = Tests::GetOrCreateResource<PrefabResource>(context, "@/SceneSynchronization/SimpleTest.prefab", CreateSimpleTestPrefab);
+
+    // Setup scenes
+    const auto quality = Tests::ConnectionQuality{0.08f, 0.12f, 0.20f, 0, 0};
+    const float positionError = 0.005f;
+
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientScene = MakeShared<Scene>(context);
+
+    Node* serverNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, "Node");
+    auto serverTransform = serverNode->GetComponent<ReplicatedTransform>();
+    serverTransform->SetQuantize(true);
+
+    // Animate object forever
+    serverScene->SubscribeToEvent(serverScene, E_SCENEUPDATE,
+        [&](VariantMap& eventData)
+    {
+        const float timeStep = eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+        serverNode->Translate(timeStep * Vector3::LEFT, TS_PARENT);
+        serverNode->Rotate({ timeStep * 10.0f, Vector3::UP }, TS_PARENT);
+    });
+
+    Tests::NetworkSimulator sim(serverScene);
+    sim.SimulateTime(1.0f);
+
+    sim.AddClient(clientScene, quality);
+    sim.SimulateTime(9.0f);
+
+    // Expect positions and rotations to be synchronized up to quantization error
+    {
+        const auto& clientReplica = *clientScene->GetComponent<ReplicationManager>()->GetClientReplica();
+        const NetworkTime replicaTime = clientReplica.GetReplicaTime();
+
+        auto clientNode = clientScene->GetChild("Node", true);
+        auto clientTransform = clientNode->GetComponent<ReplicatedTransform>();
+        REQUIRE(clientTransform->GetQuantize());
+
+        REQUIRE(serverTransform->SampleTemporalPosition(replicaTime).value_.Equals(clientNode->GetWorldPosition(), positionError));
+        REQUIRE(serverTransform->SampleTemporalRotation(replicaTime).value_.Equivalent(clientNode->GetWorldRotation(), 0.0001f));
+    }
+}
+
 TEST_CASE("Prefabs are replicated on clients")
 {
     auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
@@ -550,3 +598,234 @@ TEST_CASE("Ownership is consistent on server and on clients")
     REQUIRE(serverReplicator->GetNetworkObjectOwnedByConnection(sim.GetServerToClientConnection(clientScenes[2])) == nullptr);
 
 }
+
+TEST_CASE("Scene is synchronized with many clients")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto prefab = Tests::GetOrCreateResource<PrefabResource>(context, "@/SceneSynchronization/SimpleTest.prefab", CreateSimpleTestPrefab);
+
+    // Setup scenes
+    const auto quality = Tests::ConnectionQuality{ 0.08f, 0.12f, 0.20f, 0.02f, 0.02f };
+    const unsigned numClients = 16;
+    const unsigned numNodes = 8;
+
+    auto serverScene = MakeShared<Scene>(context);
+    ea::vector<SharedPtr<Scene>> clientScenes;
+    for (unsigned i = 0; i < numClients; ++i)
+        clientScenes.push_back(MakeShared<Scene>(context));
+
+    ea::vector<Node*> serverNodes;
+    for (unsigned i = 0; i < numNodes; ++i)
+        serverNodes.push_back(Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, Format("Node {}", i)));
+
+    // Move objects for some time, then stop them
+    bool isMoving = true;
+    serverScene->SubscribeToEvent(serverScene, E_SCENEUPDATE,
+        [&](VariantMap& eventData)
+    {
+        if (!isMoving)
+            return;
+
+        const float timeStep = eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+        for (unsigned i = 0; i < numNodes; ++i)
+            serverNodes[i]->Translate(timeStep * static_cast<float>(i + 1) * Vector3::LEFT, TS_PARENT);
+    });
+
+    // Add clients in different frames
+    Tests::NetworkSimulator sim(serverScene);
+    for (Scene* clientScene : clientScenes)
+    {
+        sim.AddClient(clientScene, quality);
+        sim.SimulateTime(0.1f);
+    }
+    sim.SimulateTime(3.0f);
+
+    isMoving = false;
+    sim.SimulateTime(3.0f);
+
+    for (Scene* clientScene : clientScenes)
+    {
+        REQUIRE(clientScene->GetNumChildren() == numNodes);
+        for (unsigned i = 0; i < numNodes; ++i)
+        {
+            auto clientNode = clientScene->GetChild(Format("Node {}", i), true);
+            REQUIRE(clientNode);
+            REQUIRE(clientNode->GetWorldPosition().Equals(serverNodes[i]->GetWorldPosition(), M_LARGE_EPSILON));
+        }
+    }
+}
+
+TEST_CASE("Unreliable updates are prioritized within bandwidth budget")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto prefab = Tests::GetOrCreateResource<PrefabResource>(context, "@/SceneSynchronization/SimpleTest.prefab", CreateSimpleTestPrefab);
+
+    // Setup scenes
+    const auto quality = Tests::ConnectionQuality{ 0.08f, 0.12f, 0.20f, 0, 0 };
+    const unsigned numNodes = 10;
+    const unsigned updateBudget = 100;
+
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientScene = MakeShared<Scene>(context);
+
+    ea::vector<Node*> serverNodes;
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        Node* serverNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, Format("Node {}", i));
+        serverNode->GetComponent<ReplicatedTransform>()->SetNumUploadAttempts(0);
+        serverNodes.push_back(serverNode);
+    }
+    serverNodes[0]->GetComponent<BehaviorNetworkObject>()->SetUpdatePriority(100.0f);
+
+    // Move objects for some time, then stop them
+    bool isMoving = true;
+    serverScene->SubscribeToEvent(serverScene, E_SCENEUPDATE,
+        [&](VariantMap& eventData)
+    {
+        if (!isMoving)
+            return;
+
+        const float timeStep = eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+        for (Node* serverNode : serverNodes)
+            serverNode->Translate(timeStep * Vector3::LEFT, TS_PARENT);
+    });
+
+    Tests::NetworkSimulator sim(serverScene);
+    auto serverReplicator = serverScene->GetComponent<ReplicationManager>()->GetServerReplicator();
+    serverReplicator->SetSetting(NetworkSettings::UnreliableUpdateBudget, updateBudget);
+
+    sim.AddClient(clientScene, quality);
+    sim.SimulateTime(3.0f);
+
+    // Expect only some updates to be sent each frame
+    AbstractConnection* connection = sim.GetServerToClientConnection(clientScene);
+    {
+        const ClientPriorityStats stats = serverReplicator->GetPriorityStats(connection);
+        REQUIRE(stats.numUpdatesSent_ > 0);
+        REQUIRE(stats.numUpdatesDeferred_ > 0);
+        REQUIRE(stats.numUpdatesSent_ + stats.numUpdatesDeferred_ == numNodes);
+        REQUIRE(stats.numBytesSent_ <= updateBudget);
+    }
+
+    // Expect all objects to be eventually synchronized
+    isMoving = false;
+    sim.SimulateTime(3.0f);
+
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        auto clientNode = clientScene->GetChild(Format("Node {}", i), true);
+        REQUIRE(clientNode);
+        REQUIRE(clientNode->GetWorldPosition().Equals(serverNodes[i]->GetWorldPosition(), M_LARGE_EPSILON));
+    }
+}
+
+TEST_CASE("Scene with many objects is cooked in parallel")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto prefab = Tests::GetOrCreateResource<PrefabResource>(context, "@/SceneSynchronization/SimpleTest.prefab", CreateSimpleTestPrefab);
+
+    // Setup scenes
+    const auto quality = Tests::ConnectionQuality{ 0.08f, 0.12f, 0.20f, 0, 0 };
+    const unsigned numNodes = SharedReplicationState::CookingBatchSize * 4 + 1;
+
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientScene = MakeShared<Scene>(context);
+
+    ea::vector<Node*> serverNodes;
+    for (unsigned i = 0; i < numNodes; ++i)
+        serverNodes.push_back(Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, Format("Node {}", i)));
+
+    // Move objects for some time, then stop them
+    bool isMoving = true;
+    serverScene->SubscribeToEvent(serverScene, E_SCENEUPDATE,
+        [&](VariantMap& eventData)
+    {
+        if (!isMoving)
+            return;
+
+        const float timeStep = eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+        for (unsigned i = 0; i < numNodes; ++i)
+            serverNodes[i]->Translate(timeStep * static_cast<float>(i % 8 + 1) * Vector3::LEFT, TS_PARENT);
+    });
+
+    Tests::NetworkSimulator sim(serverScene);
+    sim.AddClient(clientScene, quality);
+    sim.SimulateTime(2.0f);
+
+    isMoving = false;
+    sim.SimulateTime(2.0f);
+
+    REQUIRE(clientScene->GetNumChildren() == numNodes);
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        auto clientNode = clientScene->GetChild(Format("Node {}", i), true);
+        REQUIRE(clientNode);
+        REQUIRE(clientNode->GetWorldPosition().Equals(serverNodes[i]->GetWorldPosition(), M_LARGE_EPSILON));
+    }
+}
+
+TEST_CASE("Snapshots are compressed and paced when client joins")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto prefab = Tests::GetOrCreateResource<PrefabResource>(context, "@/SceneSynchronization/SimpleTest.prefab", CreateSimpleTestPrefab);
+
+    // Setup scenes
+    const auto quality = Tests::ConnectionQuality{ 0.08f, 0.12f, 0.20f, 0, 0 };
+    const unsigned numNodes = 100;
+    const unsigned snapshotBudget = 1000;
+
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientScene = MakeShared<Scene>(context);
+
+    ea::vector<Node*> serverNodes;
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        serverNodes.push_back(Tests::SpawnOnServer<BehaviorNetworkObject>(
+            serverScene, prefab, Format("Node {}", i), Vector3::LEFT * static_cast<float>(i)));
+    }
+
+    Tests::NetworkSimulator sim(serverScene);
+    auto serverReplicator = serverScene->GetComponent<ReplicationManager>()->GetServerReplicator();
+    serverReplicator->SetSetting(NetworkSettings::SnapshotBudget, snapshotBudget);
+    serverReplicator->SetSetting(NetworkSettings::SnapshotCompression, true);
+
+    sim.AddClient(clientScene, quality);
+    AbstractConnection* connection = sim.GetServerToClientConnection(clientScene);
+
+    // Expect snapshots to be sent over multiple frames
+    bool hasPendingSnapshots = false;
+    for (unsigned i = 0; i < Tests::NetworkSimulator::FramesInSecond * 2; ++i)
+    {
+        sim.SimulateTime(1.0f / Tests::NetworkSimulator::FramesInSecond);
+        if (serverReplicator->GetSnapshotStats(connection).numSnapshotsPending_ > 0)
+            hasPendingSnapshots = true;
+    }
+    REQUIRE(hasPendingSnapshots);
+
+    sim.SimulateTime(3.0f);
+
+    // Expect all objects to be delivered and compressed
+    const ClientSnapshotStats stats = serverReplicator->GetSnapshotStats(connection);
+    REQUIRE(stats.numSnapshotsPending_ == 0);
+    REQUIRE(stats.numSnapshotsSent_ == numNodes);
+    REQUIRE(stats.numCompressedBytes_ < stats.numRawBytes_);
+
+    const auto& clientReplica = *clientScene->GetComponent<ReplicationManager>()->GetClientReplica();
+    REQUIRE(clientReplica.GetNumPendingSnapshots() == 0);
+    REQUIRE(clientReplica.GetNumReceivedSnapshots() == numNodes);
+
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        auto clientNode = clientScene->GetChild(Format("Node {}", i), true);
+        REQUIRE(clientNode);
+        REQUIRE(clientNode->GetWorldPosition().Equals(serverNodes[i]->GetWorldPosition(), M_LARGE_EPSILON));
+    }
+}
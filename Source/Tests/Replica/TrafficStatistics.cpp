@@ -0,0 +1,157 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+#include "../NetworkUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Network/NetworkStatistics.h>
+#include <Urho3D/Replica/BehaviorNetworkObject.h>
+#include <Urho3D/Replica/ReplicatedTransform.h>
+#include <Urho3D/Scene/PrefabResource.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneEvents.h>
+
+namespace
+{
+
+SharedPtr<PrefabResource> CreateTestPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+    node->CreateComponent<ReplicatedTransform>();
+
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+const NetworkTrafficSample* FindSample(
+    const NetworkStatistics& statistics, NetworkTrafficCategory category, ea::string_view name)
+{
+    for (const auto& [key, sample] : statistics.GetSamples(category))
+    {
+        if (sample.name_ == name)
+            return &sample;
+    }
+    return nullptr;
+}
+
+}
+
+TEST_CASE("Network traffic statistics are accumulated and sampled per frame")
+{
+    NetworkStatistics statistics;
+    statistics.RecordMessage(MSG_USER, true, 100);
+    statistics.RecordMessage(MSG_USER, false, 20);
+    statistics.RecordMessage(MSG_CLOCK_SYNC, false, 8);
+    statistics.EndFrame(0.5f);
+
+    const auto samples = statistics.GetSortedSamples(NetworkTrafficCategory::Message);
+    REQUIRE(samples.size() == 2);
+    REQUIRE(samples[0]->lastFrame_.numReliableMessages_ == 1);
+    REQUIRE(samples[0]->lastFrame_.numUnreliableMessages_ == 1);
+    REQUIRE(samples[0]->lastFrame_.GetNumBytes() == 120);
+    REQUIRE(samples[0]->bytesPerSecond_ == Catch::Approx(120.0f));
+    REQUIRE(samples[1]->total_.GetNumBytes() == 8);
+
+    // Counters of the last frame are reset, totals are kept
+    statistics.EndFrame(0.5f);
+    REQUIRE(samples[0]->lastFrame_.GetNumBytes() == 0);
+    REQUIRE(samples[0]->total_.GetNumBytes() == 120);
+    REQUIRE(statistics.GetNumFrames() == 2);
+
+    NetworkStatistics mergedStatistics;
+    mergedStatistics.Merge(statistics);
+    mergedStatistics.Merge(statistics);
+    REQUIRE(mergedStatistics.GetSortedSamples(NetworkTrafficCategory::Message)[0]->total_.GetNumBytes() == 240);
+}
+
+TEST_CASE("Network traffic statistics are broken down by object and behavior")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto prefab = Tests::GetOrCreateResource<PrefabResource>(context, "@/TrafficStatistics/Test.prefab", CreateTestPrefab);
+
+    // Setup scenes
+    const auto quality = Tests::ConnectionQuality{0.08f, 0.12f, 0.20f, 0, 0};
+
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientScene = MakeShared<Scene>(context);
+
+    const unsigned numNodes = 3;
+    ea::vector<Node*> serverNodes;
+    for (unsigned i = 0; i < numNodes; ++i)
+        serverNodes.push_back(Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, Format("Node {}", i)));
+
+    serverScene->SubscribeToEvent(serverScene, E_SCENEUPDATE,
+        [&](VariantMap& eventData)
+    {
+        const float timeStep = eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+        for (Node* serverNode : serverNodes)
+            serverNode->Translate(timeStep * Vector3::LEFT, TS_PARENT);
+    });
+
+    Tests::NetworkSimulator sim(serverScene);
+    sim.AddClient(clientScene, quality);
+
+    AbstractConnection* connection = sim.GetServerToClientConnection(clientScene);
+    connection->SetTrafficStatisticsEnabled(true);
+    sim.SimulateTime(3.0f);
+
+    const NetworkStatistics* statistics = connection->GetTrafficStatistics();
+    REQUIRE(statistics);
+    REQUIRE(statistics->GetNumFrames() > 0);
+
+    // Snapshots are sent reliably, then objects are updated unreliably
+    REQUIRE(statistics->GetSamples(NetworkTrafficCategory::Message).contains(MSG_ADD_OBJECTS));
+    REQUIRE(statistics->GetSamples(NetworkTrafficCategory::Message).contains(MSG_UPDATE_OBJECTS_UNRELIABLE));
+    REQUIRE(statistics->GetSamples(NetworkTrafficCategory::Object).size() == numNodes);
+
+    for (const auto& [key, sample] : statistics->GetSamples(NetworkTrafficCategory::Object))
+    {
+        REQUIRE(sample.total_.numReliableMessages_ > 0);
+        REQUIRE(sample.total_.numUnreliableMessages_ > 0);
+        REQUIRE(sample.bytesPerSecond_ > 0.0f);
+    }
+
+    const NetworkTrafficSample* transformSample =
+        FindSample(*statistics, NetworkTrafficCategory::Component, ReplicatedTransform::GetTypeNameStatic());
+    REQUIRE(transformSample);
+    REQUIRE(transformSample->total_.numUnreliableBytes_ > 0);
+
+    // Object bytes are fully attributed to components
+    unsigned long long objectBytes = 0;
+    for (const auto& [key, sample] : statistics->GetSamples(NetworkTrafficCategory::Object))
+        objectBytes += sample.total_.GetNumBytes();
+    unsigned long long componentBytes = 0;
+    for (const auto& [key, sample] : statistics->GetSamples(NetworkTrafficCategory::Component))
+        componentBytes += sample.total_.GetNumBytes();
+    REQUIRE(objectBytes == componentBytes);
+
+    // Statistics can be exported
+    VectorBuffer csv;
+    statistics->WriteCSV(csv);
+    const ea::string csvText{reinterpret_cast<const char*>(csv.GetData()), csv.GetSize()};
+    REQUIRE(csvText.starts_with("Category,Name,"));
+    REQUIRE(csvText.contains(ReplicatedTransform::GetTypeNameStatic()));
+}
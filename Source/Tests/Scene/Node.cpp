@@ -44,3 +44,20 @@ TEST_CASE("Load node from XML node file")
     CHECK(child->GetName() == "NodeName");
     CHECK(child->GetComponent<StaticModel>());
 };
+
+TEST_CASE("Node world transform is converted to parent space")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = MakeShared<Scene>(context);
+
+    auto parent = scene->CreateChild("Parent");
+    parent->SetTransform({1.0f, 2.0f, 3.0f}, Quaternion{30.0f, Vector3::UP}, Vector3{2.0f, 1.0f, 0.5f});
+    auto child = parent->CreateChild("Child");
+
+    const Vector3 worldPosition{-4.0f, 5.0f, 6.0f};
+    const Quaternion worldRotation{45.0f, Vector3::RIGHT};
+    child->SetWorldTransform(worldPosition, worldRotation);
+
+    REQUIRE(child->GetWorldPosition().Equals(worldPosition, 0.0001f));
+    REQUIRE(child->GetWorldRotation().Equivalent(worldRotation, 0.0001f));
+}
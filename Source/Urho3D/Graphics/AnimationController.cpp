@@ -30,6 +30,7 @@
 #include "../Graphics/AnimationState.h"
 #include "../Graphics/DrawableEvents.h"
 #include "../Graphics/Renderer.h"
+#include "../IO/BitStream.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
@@ -98,6 +99,16 @@ bool MatchesQuery(const AnimationParameters& params, Animation* animation, unsig
     return true;
 }
 
+void WriteQuantizedUnitFloat(BitWriter& dest, float value, unsigned numBits)
+{
+    dest.WriteQuantizedFloat(value * 2.0f - 1.0f, 1.0f, numBits);
+}
+
+float ReadQuantizedUnitFloat(BitReader& src, unsigned numBits)
+{
+    return (src.ReadQuantizedFloat(1.0f, numBits) + 1.0f) * 0.5f;
+}
+
 }
 
 AnimationParameters::AnimationParameters(Animation* animation)
@@ -247,7 +258,7 @@ void AnimationParameters::ToVariantSpan(ea::span<Variant> variants) const
     URHO3D_ASSERT(index == NumVariants);
 }
 
-AnimationParameters AnimationParameters::Deserialize(Animation* animation, Deserializer& src)
+AnimationParameters AnimationParameters::Deserialize(Animation* animation, Deserializer& src, unsigned quantizationBits)
 {
     AnimationParameters result{animation};
 
@@ -275,12 +286,30 @@ AnimationParameters AnimationParameters::Deserialize(Animation* animation, Deser
     float minTime = 0.0f;
     float maxTime = result.animation_ ? result.animation_->GetLength() : 0.0f;
 
-    if (flags.Test(AnimationParameterMask::Time))
-        time = src.ReadFloat();
-    if (flags.Test(AnimationParameterMask::MinTime))
-        minTime = src.ReadFloat();
-    if (flags.Test(AnimationParameterMask::MaxTime))
-        maxTime = src.ReadFloat();
+    if (quantizationBits != 0)
+    {
+        if (flags.Test(AnimationParameterMask::MinTime))
+            minTime = src.ReadFloat();
+        if (flags.Test(AnimationParameterMask::MaxTime))
+            maxTime = src.ReadFloat();
+
+        BitReader bits{src};
+        if (flags.Test(AnimationParameterMask::Time))
+            time = ReadQuantizedUnitFloat(bits, quantizationBits) * (maxTime - minTime) + minTime;
+        if (flags.Test(AnimationParameterMask::Weight))
+            result.weight_ = ReadQuantizedUnitFloat(bits, quantizationBits);
+        if (flags.Test(AnimationParameterMask::TargetWeight))
+            result.targetWeight_ = ReadQuantizedUnitFloat(bits, quantizationBits);
+    }
+    else
+    {
+        if (flags.Test(AnimationParameterMask::Time))
+            time = src.ReadFloat();
+        if (flags.Test(AnimationParameterMask::MinTime))
+            minTime = src.ReadFloat();
+        if (flags.Test(AnimationParameterMask::MaxTime))
+            maxTime = src.ReadFloat();
+    }
 
     result.time_ = {time, minTime, maxTime};
 
@@ -289,11 +318,14 @@ AnimationParameters AnimationParameters::Deserialize(Animation* animation, Deser
 
     result.removeOnZeroWeight_ = flags.Test(AnimationParameterMask::RemoveOnZeroWeight);
 
-    if (flags.Test(AnimationParameterMask::Weight))
-        result.weight_ = src.ReadFloat();
+    if (quantizationBits == 0)
+    {
+        if (flags.Test(AnimationParameterMask::Weight))
+            result.weight_ = src.ReadFloat();
 
-    if (flags.Test(AnimationParameterMask::TargetWeight))
-        result.targetWeight_ = src.ReadFloat();
+        if (flags.Test(AnimationParameterMask::TargetWeight))
+            result.targetWeight_ = src.ReadFloat();
+    }
 
     if (flags.Test(AnimationParameterMask::TargetWeightDelay))
         result.targetWeightDelay_ = src.ReadFloat();
@@ -301,7 +333,7 @@ AnimationParameters AnimationParameters::Deserialize(Animation* animation, Deser
     return result;
 }
 
-void AnimationParameters::Serialize(Serializer& dest) const
+void AnimationParameters::Serialize(Serializer& dest, unsigned quantizationBits) const
 {
     AnimationParameterFlags flags;
     flags.Set(AnimationParameterMask::InstanceIndex, instanceIndex_ != 0);
@@ -329,18 +361,44 @@ void AnimationParameters::Serialize(Serializer& dest) const
         dest.WriteString(startBone_);
     if (flags.Test(AnimationParameterMask::AutoFadeOutTime))
         dest.WriteFloat(autoFadeOutTime_);
-    if (flags.Test(AnimationParameterMask::Time))
-        dest.WriteFloat(time_.Value());
-    if (flags.Test(AnimationParameterMask::MinTime))
-        dest.WriteFloat(time_.Min());
-    if (flags.Test(AnimationParameterMask::MaxTime))
-        dest.WriteFloat(time_.Max());
+
+    if (quantizationBits != 0)
+    {
+        if (flags.Test(AnimationParameterMask::MinTime))
+            dest.WriteFloat(time_.Min());
+        if (flags.Test(AnimationParameterMask::MaxTime))
+            dest.WriteFloat(time_.Max());
+
+        BitWriter bits{dest};
+        const float timeRange = time_.Max() - time_.Min();
+        if (flags.Test(AnimationParameterMask::Time))
+            WriteQuantizedUnitFloat(bits, timeRange > 0.0f ? (time_.Value() - time_.Min()) / timeRange : 0.0f, quantizationBits);
+        if (flags.Test(AnimationParameterMask::Weight))
+            WriteQuantizedUnitFloat(bits, weight_, quantizationBits);
+        if (flags.Test(AnimationParameterMask::TargetWeight))
+            WriteQuantizedUnitFloat(bits, targetWeight_, quantizationBits);
+    }
+    else
+    {
+        if (flags.Test(AnimationParameterMask::Time))
+            dest.WriteFloat(time_.Value());
+        if (flags.Test(AnimationParameterMask::MinTime))
+            dest.WriteFloat(time_.Min());
+        if (flags.Test(AnimationParameterMask::MaxTime))
+            dest.WriteFloat(time_.Max());
+    }
+
     if (flags.Test(AnimationParameterMask::Speed))
         dest.WriteFloat(speed_);
-    if (flags.Test(AnimationParameterMask::Weight))
-        dest.WriteFloat(weight_);
-    if (flags.Test(AnimationParameterMask::TargetWeight))
-        dest.WriteFloat(targetWeight_);
+
+    if (quantizationBits == 0)
+    {
+        if (flags.Test(AnimationParameterMask::Weight))
+            dest.WriteFloat(weight_);
+        if (flags.Test(AnimationParameterMask::TargetWeight))
+            dest.WriteFloat(targetWeight_);
+    }
+
     if (flags.Test(AnimationParameterMask::TargetWeightDelay))
         dest.WriteFloat(targetWeightDelay_);
 }
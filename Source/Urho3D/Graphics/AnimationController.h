@@ -100,8 +100,9 @@ struct URHO3D_API AnimationParameters
     static AnimationParameters FromVariantSpan(Context* context, ea::span<const Variant> variants);
     void ToVariantSpan(ea::span<Variant> variants) const;
 
-    static AnimationParameters Deserialize(Animation* animation, Deserializer& src);
-    void Serialize(Serializer& dest) const;
+    static AnimationParameters Deserialize(Animation* animation, Deserializer& src, unsigned quantizationBits = 0);
+    /// If quantization bits are non-zero, time within [min, max] and weights are quantized to specified bit width.
+    void Serialize(Serializer& dest, unsigned quantizationBits = 0) const;
 
     bool IsMergeableWith(const AnimationParameters& rhs) const;
 
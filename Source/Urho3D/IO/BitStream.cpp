@@ -0,0 +1,235 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Assert.h"
+#include "../IO/BitStream.h"
+#include "../IO/Deserializer.h"
+#include "../IO/Serializer.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Max absolute value of any quaternion component except the largest one.
+const float smallestThreeRange = 0.70710678f;
+
+unsigned GetMaxQuantizedValue(unsigned numBits)
+{
+    return (1u << (numBits - 1)) - 1;
+}
+
+unsigned GetLargestComponentIndex(const Quaternion& value)
+{
+    const float components[4] = {Abs(value.w_), Abs(value.x_), Abs(value.y_), Abs(value.z_)};
+    unsigned index = 0;
+    for (unsigned i = 1; i < 4; ++i)
+    {
+        if (components[i] > components[index])
+            index = i;
+    }
+    return index;
+}
+
+}
+
+unsigned QuantizeFloat(float value, float range, unsigned numBits)
+{
+    URHO3D_ASSERT(numBits >= 2 && numBits <= BitWriter::MaxQuantizationBits);
+    URHO3D_ASSERT(range > 0.0f);
+
+    // Use symmetric range so that zero is represented exactly
+    const int maxValue = static_cast<int>(GetMaxQuantizedValue(numBits));
+    const int quantized = RoundToInt(Clamp(value / range, -1.0f, 1.0f) * maxValue);
+    return static_cast<unsigned>(quantized + maxValue);
+}
+
+float DequantizeFloat(unsigned value, float range, unsigned numBits)
+{
+    URHO3D_ASSERT(numBits >= 2 && numBits <= BitWriter::MaxQuantizationBits);
+
+    const int maxValue = static_cast<int>(GetMaxQuantizedValue(numBits));
+    const int quantized = ea::min(static_cast<int>(value), 2 * maxValue) - maxValue;
+    return static_cast<float>(quantized) / maxValue * range;
+}
+
+BitWriter::BitWriter(Serializer& dest)
+    : dest_(dest)
+{
+}
+
+BitWriter::~BitWriter()
+{
+    Flush();
+}
+
+void BitWriter::WriteBits(unsigned value, unsigned numBits)
+{
+    URHO3D_ASSERT(numBits <= MaxBitsPerWrite);
+    if (numBits == 0)
+        return;
+
+    const unsigned long long mask = (1ull << numBits) - 1;
+    scratch_ |= (static_cast<unsigned long long>(value) & mask) << numScratchBits_;
+    numScratchBits_ += numBits;
+    numBitsWritten_ += numBits;
+
+    while (numScratchBits_ >= 8)
+    {
+        dest_.WriteUByte(static_cast<unsigned char>(scratch_ & 0xff));
+        scratch_ >>= 8;
+        numScratchBits_ -= 8;
+    }
+}
+
+void BitWriter::WriteBool(bool value)
+{
+    WriteBits(value ? 1 : 0, 1);
+}
+
+void BitWriter::WriteQuantizedFloat(float value, float range, unsigned numBits)
+{
+    WriteBits(QuantizeFloat(value, range, numBits), numBits);
+}
+
+void BitWriter::WriteQuantizedVector3(const Vector3& value, float range, unsigned numBits)
+{
+    WriteQuantizedFloat(value.x_, range, numBits);
+    WriteQuantizedFloat(value.y_, range, numBits);
+    WriteQuantizedFloat(value.z_, range, numBits);
+}
+
+void BitWriter::WriteQuantizedVelocity(const Vector3& value, float range, unsigned numBits)
+{
+    const bool isZero = value == Vector3::ZERO;
+    WriteBool(!isZero);
+    if (!isZero)
+        WriteQuantizedVector3(value, range, numBits);
+}
+
+void BitWriter::WriteSmallestThreeQuaternion(const Quaternion& value, unsigned numBits)
+{
+    Quaternion norm = value.Normalized();
+    const unsigned largestIndex = GetLargestComponentIndex(norm);
+
+    // q and -q represent the same rotation, keep the largest component positive so it can be restored from the rest
+    const float components[4] = {norm.w_, norm.x_, norm.y_, norm.z_};
+    const float sign = components[largestIndex] < 0.0f ? -1.0f : 1.0f;
+
+    WriteBits(largestIndex, 2);
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i != largestIndex)
+            WriteQuantizedFloat(components[i] * sign, smallestThreeRange, numBits);
+    }
+}
+
+void BitWriter::Flush()
+{
+    if (numScratchBits_ > 0)
+    {
+        dest_.WriteUByte(static_cast<unsigned char>(scratch_ & 0xff));
+        scratch_ = 0;
+        numScratchBits_ = 0;
+    }
+}
+
+BitReader::BitReader(Deserializer& src)
+    : src_(src)
+{
+}
+
+unsigned BitReader::ReadBits(unsigned numBits)
+{
+    URHO3D_ASSERT(numBits <= BitWriter::MaxBitsPerWrite);
+    if (numBits == 0)
+        return 0;
+
+    while (numScratchBits_ < numBits)
+    {
+        if (src_.IsEof())
+        {
+            overflow_ = true;
+            numScratchBits_ = numBits;
+            break;
+        }
+
+        scratch_ |= static_cast<unsigned long long>(src_.ReadUByte()) << numScratchBits_;
+        numScratchBits_ += 8;
+    }
+
+    const unsigned long long mask = (1ull << numBits) - 1;
+    const auto result = static_cast<unsigned>(scratch_ & mask);
+    scratch_ >>= numBits;
+    numScratchBits_ -= numBits;
+    return result;
+}
+
+bool BitReader::ReadBool()
+{
+    return ReadBits(1) != 0;
+}
+
+float BitReader::ReadQuantizedFloat(float range, unsigned numBits)
+{
+    return DequantizeFloat(ReadBits(numBits), range, numBits);
+}
+
+Vector3 BitReader::ReadQuantizedVector3(float range, unsigned numBits)
+{
+    const float x = ReadQuantizedFloat(range, numBits);
+    const float y = ReadQuantizedFloat(range, numBits);
+    const float z = ReadQuantizedFloat(range, numBits);
+    return {x, y, z};
+}
+
+Vector3 BitReader::ReadQuantizedVelocity(float range, unsigned numBits)
+{
+    const bool isZero = !ReadBool();
+    return isZero ? Vector3::ZERO : ReadQuantizedVector3(range, numBits);
+}
+
+Quaternion BitReader::ReadSmallestThreeQuaternion(unsigned numBits)
+{
+    const unsigned largestIndex = ReadBits(2);
+
+    float components[4]{};
+    float sumSquares = 0.0f;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i != largestIndex)
+        {
+            components[i] = ReadQuantizedFloat(smallestThreeRange, numBits);
+            sumSquares += components[i] * components[i];
+        }
+    }
+    components[largestIndex] = Sqrt(ea::max(0.0f, 1.0f - sumSquares));
+
+    return Quaternion{components[0], components[1], components[2], components[3]}.Normalized();
+}
+
+}
@@ -0,0 +1,111 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/// \file
+
+#pragma once
+
+#include "../Core/NonCopyable.h"
+#include "../Math/Quaternion.h"
+#include "../Math/Vector3.h"
+
+namespace Urho3D
+{
+
+class Deserializer;
+class Serializer;
+
+/// Quantize float within [-range, range] into unsigned integer of specified bit width.
+URHO3D_API unsigned QuantizeFloat(float value, float range, unsigned numBits);
+/// Restore float quantized by QuantizeFloat.
+URHO3D_API float DequantizeFloat(unsigned value, float range, unsigned numBits);
+
+/// Bit-level writer on top of Serializer.
+/// Bits are accumulated and written to destination in whole bytes.
+/// The last byte is padded with zeros on Flush, so byte-aligned data may follow.
+/// @nobind
+class URHO3D_API BitWriter : public NonCopyable
+{
+public:
+    static constexpr unsigned MaxBitsPerWrite = 32;
+    static constexpr unsigned MaxQuantizationBits = 24;
+
+    explicit BitWriter(Serializer& dest);
+    ~BitWriter();
+
+    /// Write lowest bits of the value.
+    void WriteBits(unsigned value, unsigned numBits);
+    /// Write single bit.
+    void WriteBool(bool value);
+    /// Write float quantized within [-range, range]. Value is clamped.
+    void WriteQuantizedFloat(float value, float range, unsigned numBits);
+    /// Write vector quantized within [-range, range] per component.
+    void WriteQuantizedVector3(const Vector3& value, float range, unsigned numBits);
+    /// Write vector quantized within [-range, range] per component, with single bit for zero vector.
+    void WriteQuantizedVelocity(const Vector3& value, float range, unsigned numBits);
+    /// Write normalized quaternion using smallest three encoding: 2 bits of index and three quantized components.
+    void WriteSmallestThreeQuaternion(const Quaternion& value, unsigned numBits);
+    /// Write pending bits to destination, padding the last byte.
+    void Flush();
+
+    /// Return total number of bits written, including pending ones.
+    unsigned GetNumBitsWritten() const { return numBitsWritten_; }
+
+private:
+    Serializer& dest_;
+    unsigned long long scratch_{};
+    unsigned numScratchBits_{};
+    unsigned numBitsWritten_{};
+};
+
+/// Bit-level reader on top of Deserializer. Mirrors BitWriter.
+/// Bytes are consumed from the source on demand, the rest of partially read byte is discarded on destruction.
+/// @nobind
+class URHO3D_API BitReader : public NonCopyable
+{
+public:
+    explicit BitReader(Deserializer& src);
+
+    /// Read bits into lowest bits of the result.
+    unsigned ReadBits(unsigned numBits);
+    /// Read single bit.
+    bool ReadBool();
+    /// Read float quantized within [-range, range].
+    float ReadQuantizedFloat(float range, unsigned numBits);
+    /// Read vector quantized within [-range, range] per component.
+    Vector3 ReadQuantizedVector3(float range, unsigned numBits);
+    /// Read vector written by WriteQuantizedVelocity.
+    Vector3 ReadQuantizedVelocity(float range, unsigned numBits);
+    /// Read quaternion written with smallest three encoding.
+    Quaternion ReadSmallestThreeQuaternion(unsigned numBits);
+
+    /// Return whether the reader tried to read past the end of the source.
+    bool IsOverflow() const { return overflow_; }
+
+private:
+    Deserializer& src_;
+    unsigned long long scratch_{};
+    unsigned numScratchBits_{};
+    bool overflow_{};
+};
+
+}
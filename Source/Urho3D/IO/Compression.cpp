@@ -56,6 +56,36 @@ unsigned DecompressData(void* dest, const void* src, unsigned destSize)
         return (unsigned)LZ4_decompress_fast((const char*)src, (char*)dest, destSize);
 }
 
+unsigned CompressDataWithDictionary(void* dest, const void* src, unsigned srcSize, const void* dictionary, unsigned dictionarySize)
+{
+    if (!dest || !src || !srcSize)
+        return 0;
+
+    LZ4_stream_t stream;
+    LZ4_resetStream(&stream);
+    if (dictionary && dictionarySize)
+        LZ4_loadDict(&stream, (const char*)dictionary, dictionarySize);
+
+    return (unsigned)LZ4_compress_fast_continue(&stream, (const char*)src, (char*)dest, srcSize, LZ4_compressBound(srcSize), 1);
+}
+
+bool DecompressDataWithDictionary(void* dest, unsigned destSize, const void* src, unsigned srcSize, const void* dictionary, unsigned dictionarySize)
+{
+    if (!dest || !src || !destSize || !srcSize)
+        return false;
+
+    // Only the last 64KB of the dictionary are used by LZ4
+    if (dictionarySize > MaxCompressionDictionarySize)
+    {
+        dictionary = (const char*)dictionary + dictionarySize - MaxCompressionDictionarySize;
+        dictionarySize = MaxCompressionDictionarySize;
+    }
+
+    const int result = LZ4_decompress_safe_usingDict((const char*)src, (char*)dest, srcSize, destSize,
+        (const char*)dictionary, dictionary ? dictionarySize : 0);
+    return result == (int)destSize;
+}
+
 bool CompressStream(Serializer& dest, Deserializer& src)
 {
     unsigned srcSize = src.GetSize() - src.GetPosition();
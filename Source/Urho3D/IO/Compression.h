@@ -37,6 +37,14 @@ URHO3D_API unsigned EstimateCompressBound(unsigned srcSize);
 URHO3D_API unsigned CompressData(void* dest, const void* src, unsigned srcSize);
 /// Uncompress data using the LZ4 algorithm. The uncompressed data size must be known. Return the number of compressed data bytes consumed.
 URHO3D_API unsigned DecompressData(void* dest, const void* src, unsigned destSize);
+/// Max size of dictionary used by CompressDataWithDictionary. Only the last bytes of bigger dictionary are used.
+static constexpr unsigned MaxCompressionDictionarySize = 64 * 1024;
+/// Compress data using the LZ4 algorithm and the dictionary of data expected to be similar to the input. Return the compressed data size.
+/// The needed destination buffer worst-case size is given by EstimateCompressBound(). Exactly the same dictionary should be used for decompression.
+URHO3D_API unsigned CompressDataWithDictionary(void* dest, const void* src, unsigned srcSize, const void* dictionary, unsigned dictionarySize);
+/// Uncompress data compressed by CompressDataWithDictionary. The uncompressed data size must be known.
+/// Return true if input data is valid and exactly destSize bytes were uncompressed.
+URHO3D_API bool DecompressDataWithDictionary(void* dest, unsigned destSize, const void* src, unsigned srcSize, const void* dictionary, unsigned dictionarySize);
 /// Compress a source stream (from current position to the end) to the destination stream using the LZ4 algorithm. Return true on success.
 URHO3D_API bool CompressStream(Serializer& dest, Deserializer& src);
 /// Decompress a compressed source stream produced using CompressStream() to the destination stream. Return true on success.
@@ -108,8 +108,6 @@ public:
     bool GetDrawObstacles() const { return drawObstacles_; }
 
 protected:
-    struct TileCacheData;
-
     /// Subscribe to events when assigned to a scene.
     void OnSceneSet(Scene* scene) override;
     /// Trigger the tile cache to make updates to the nav mesh if necessary.
@@ -122,10 +120,14 @@ protected:
     /// Used by Obstacle class to remove itself from the tile cache, if 'silent' an event will not be raised.
     void RemoveObstacle(Obstacle* obstacle, bool silent = false);
 
-    /// Build one tile of the navigation mesh. Return true if successful.
-    int BuildTile(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z, TileCacheData* tiles);
-    /// Build tiles in the rectangular area. Return number of built tiles.
-    unsigned BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to);
+    /// Create empty build data of the tile.
+    ea::unique_ptr<NavBuildData> CreateTileBuildData() const override;
+    /// Return function that builds tile cache layers.
+    TileBuildFunction GetTileBuildFunction() const override { return &DynamicNavigationMesh::BuildTileData; }
+    /// Replace tile cache layers with built ones. Return number of added layers.
+    unsigned AddTileData(NavBuildData& build) override;
+    /// Build tile cache layers from prepared build data. Return true if successful.
+    static bool BuildTileData(NavBuildData& build);
     /// Off-mesh connections to be rebuilt in the mesh processor.
     ea::vector<OffMeshConnection*> CollectOffMeshConnections(const BoundingBox& bounds);
     /// Release the navigation mesh, query, and tile cache.
@@ -26,6 +26,7 @@
 
 #include "../Navigation/NavBuildData.h"
 
+#include <Detour/DetourAlloc.h>
 #include <DetourTileCache/DetourTileCacheBuilder.h>
 #include <Recast/Recast.h>
 
@@ -35,7 +36,8 @@ namespace Urho3D
 NavBuildData::NavBuildData() :
     ctx_(new rcContext(true)),
     heightField_(nullptr),
-    compactHeightField_(nullptr)
+    compactHeightField_(nullptr),
+    config_(new rcConfig{})
 {
 }
 
@@ -47,6 +49,11 @@ NavBuildData::~NavBuildData()
     heightField_ = nullptr;
     rcFreeCompactHeightfield(compactHeightField_);
     compactHeightField_ = nullptr;
+    delete config_;
+    config_ = nullptr;
+
+    for (NavTileData& tileData : tileData_)
+        dtFree(tileData.data_);
 }
 
 SimpleNavBuildData::SimpleNavBuildData() :
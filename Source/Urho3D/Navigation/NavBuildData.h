@@ -25,10 +25,13 @@
 #include <EASTL/vector.h>
 
 #include "../Math/BoundingBox.h"
+#include "../Math/Vector2.h"
 #include "../Math/Vector3.h"
 
 class rcContext;
 
+struct rcConfig;
+
 struct dtTileCacheContourSet;
 struct dtTileCachePolyMesh;
 struct dtTileCacheAlloc;
@@ -51,6 +54,16 @@ struct URHO3D_API NavAreaStub
     unsigned char areaID_;
 };
 
+/// Detour data of navigation mesh tile or tile cache layer.
+/// @nobind
+struct URHO3D_API NavTileData
+{
+    /// Data allocated with dtAlloc.
+    unsigned char* data_{};
+    /// Data size.
+    int dataSize_{};
+};
+
 /// Navigation build data.
 struct URHO3D_API NavBuildData
 {
@@ -83,6 +96,22 @@ struct URHO3D_API NavBuildData
     rcCompactHeightfield* compactHeightField_;
     /// Pretransformed navigation areas, no correlation to the geometry above.
     ea::vector<NavAreaStub> navAreas_;
+
+    /// Index of the tile being built.
+    IntVector2 tile_;
+    /// Recast configuration of the tile.
+    rcConfig* config_;
+    /// Navigation agent height.
+    float agentHeight_{};
+    /// Navigation agent radius.
+    float agentRadius_{};
+    /// Navigation agent max vertical climb.
+    float agentMaxClimb_{};
+    /// Whether to use watershed partitioning.
+    bool watershedPartition_{};
+    /// Built tile data. Data that is not moved out is freed on destruction.
+    /// @nobind
+    ea::vector<NavTileData> tileData_;
 };
 
 struct URHO3D_API SimpleNavBuildData : public NavBuildData
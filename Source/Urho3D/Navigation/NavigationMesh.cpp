@@ -24,6 +24,7 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Drawable.h"
 #include "../Graphics/Geometry.h"
@@ -58,6 +59,24 @@
 namespace Urho3D
 {
 
+struct NavigationMesh::AsyncBuildState
+{
+    /// Geometry collected when the build was started.
+    ea::vector<NavigationGeometryInfo> geometryList_;
+    /// Components of the geometry, used to skip destroyed ones.
+    ea::vector<WeakPtr<Component>> components_;
+    /// Tiles to build.
+    ea::vector<IntVector2> tiles_;
+    /// Index of the next tile to dispatch.
+    unsigned nextTile_{};
+    /// Number of tiles that are being built in worker threads.
+    unsigned numTilesInFlight_{};
+    /// Number of tiles that are built and added to the navigation mesh.
+    unsigned numProcessedTiles_{};
+    /// Whether the build is cancelled.
+    std::atomic<bool> cancelled_{};
+};
+
 const char* navmeshPartitionTypeNames[] =
 {
     "watershed",
@@ -450,19 +469,11 @@ bool NavigationMesh::Build(const BoundingBox& boundingBox)
     if (!node_->GetWorldScale().Equals(Vector3::ONE))
         URHO3D_LOGWARNING("Navigation mesh root node has scaling. Agent parameters may not work as intended");
 
-    BoundingBox localSpaceBox = boundingBox.Transformed(node_->GetWorldTransform().Inverse());
-
-    float tileEdgeLength = (float)tileSize_ * cellSize_;
-
     ea::vector<NavigationGeometryInfo> geometryList;
     CollectGeometries(geometryList);
 
-    int sx = Clamp((int)((localSpaceBox.min_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
-    int sz = Clamp((int)((localSpaceBox.min_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
-    int ex = Clamp((int)((localSpaceBox.max_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
-    int ez = Clamp((int)((localSpaceBox.max_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
-
-    unsigned numTiles = BuildTiles(geometryList, IntVector2(sx, sz), IntVector2(ex, ez));
+    const auto tileRange = GetTileRange(boundingBox);
+    unsigned numTiles = BuildTiles(geometryList, tileRange.first, tileRange.second);
 
     URHO3D_LOGDEBUG("Rebuilt " + ea::to_string(numTiles) + " tiles of the navigation mesh");
     return true;
@@ -493,6 +504,148 @@ bool NavigationMesh::Build(const IntVector2& from, const IntVector2& to)
     return true;
 }
 
+bool NavigationMesh::BuildAsync(const BoundingBox& boundingBox)
+{
+    if (!node_ || !navMesh_)
+    {
+        URHO3D_LOGERROR("Navigation mesh must first be built fully before it can be partially rebuilt");
+        return false;
+    }
+
+    const auto tileRange = GetTileRange(boundingBox);
+    return BuildAsync(tileRange.first, tileRange.second);
+}
+
+bool NavigationMesh::BuildAsync(const IntVector2& from, const IntVector2& to)
+{
+    URHO3D_PROFILE("StartAsyncNavigationMeshBuild");
+
+    CancelAsyncBuild();
+
+    if (!node_)
+        return false;
+
+    if (!navMesh_)
+    {
+        URHO3D_LOGERROR("Navigation mesh must first be built fully before it can be partially rebuilt");
+        return false;
+    }
+
+    if (!node_->GetWorldScale().Equals(Vector3::ONE))
+        URHO3D_LOGWARNING("Navigation mesh root node has scaling. Agent parameters may not work as intended");
+
+    const IntVector2 clampedFrom = VectorMax(from, IntVector2::ZERO);
+    const IntVector2 clampedTo = VectorMin(to, GetNumTiles() - IntVector2::ONE);
+    if (clampedFrom.x_ > clampedTo.x_ || clampedFrom.y_ > clampedTo.y_)
+        return true; // Nothing to do
+
+    auto state = ea::make_shared<AsyncBuildState>();
+    CollectGeometries(state->geometryList_);
+    for (const NavigationGeometryInfo& info : state->geometryList_)
+        state->components_.emplace_back(info.component_);
+
+    for (int z = clampedFrom.y_; z <= clampedTo.y_; ++z)
+    {
+        for (int x = clampedFrom.x_; x <= clampedTo.x_; ++x)
+            state->tiles_.emplace_back(x, z);
+    }
+
+    asyncBuild_ = state;
+    DispatchAsyncBuildTiles();
+    return true;
+}
+
+void NavigationMesh::CancelAsyncBuild()
+{
+    if (!asyncBuild_)
+        return;
+
+    // Tasks that are already posted keep the state alive and check this flag
+    asyncBuild_->cancelled_ = true;
+    asyncBuild_ = nullptr;
+}
+
+float NavigationMesh::GetAsyncBuildProgress() const
+{
+    if (!asyncBuild_ || asyncBuild_->tiles_.empty())
+        return 1.0f;
+    return static_cast<float>(asyncBuild_->numProcessedTiles_) / asyncBuild_->tiles_.size();
+}
+
+void NavigationMesh::DispatchAsyncBuildTiles()
+{
+    AsyncBuildState& state = *asyncBuild_;
+
+    // Geometry may have been removed from the scene since the build was started
+    for (unsigned i = 0; i < state.components_.size();)
+    {
+        if (state.components_[i].Expired())
+        {
+            state.components_.erase_at(i);
+            state.geometryList_.erase_at(i);
+        }
+        else
+            ++i;
+    }
+
+    auto workQueue = GetSubsystem<WorkQueue>();
+    const unsigned maxTilesInFlight = ea::max(1u, workQueue->GetNumProcessingThreads()) * 2;
+    const TileBuildFunction buildFunction = GetTileBuildFunction();
+
+    while (state.nextTile_ < state.tiles_.size() && state.numTilesInFlight_ < maxTilesInFlight)
+    {
+        ea::shared_ptr<NavBuildData> build = PrepareTileBuild(state.geometryList_, state.tiles_[state.nextTile_]);
+        ++state.nextTile_;
+        ++state.numTilesInFlight_;
+
+        workQueue->PostTask([this, stateHolder = asyncBuild_, build, buildFunction](WorkQueue* queue)
+        {
+            const bool success = !stateHolder->cancelled_ && buildFunction(*build);
+
+            // Tiles are added between frames. Immediate main thread tasks may run inside of any parallel loop,
+            // including ones that read this navigation mesh.
+            queue->PostDelayedTaskForMainThread([this, stateHolder, build, success]()
+            {
+                --stateHolder->numTilesInFlight_;
+                // Navigation mesh may be already destroyed if the build is cancelled
+                if (stateHolder->cancelled_)
+                    return;
+
+                if (success)
+                    AddTileData(*build);
+                FinishAsyncBuildTile();
+            });
+        }, TaskPriority::Low);
+    }
+}
+
+void NavigationMesh::FinishAsyncBuildTile()
+{
+    AsyncBuildState& state = *asyncBuild_;
+    ++state.numProcessedTiles_;
+
+    if (state.numProcessedTiles_ < state.tiles_.size())
+    {
+        DispatchAsyncBuildTiles();
+        return;
+    }
+
+    URHO3D_LOGDEBUG("Rebuilt {} tiles of the navigation mesh asynchronously", state.tiles_.size());
+    asyncBuild_ = nullptr;
+}
+
+ea::pair<IntVector2, IntVector2> NavigationMesh::GetTileRange(const BoundingBox& boundingBox) const
+{
+    const BoundingBox localSpaceBox = boundingBox.Transformed(node_->GetWorldTransform().Inverse());
+    const float tileEdgeLength = (float)tileSize_ * cellSize_;
+
+    const int sx = Clamp((int)((localSpaceBox.min_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
+    const int sz = Clamp((int)((localSpaceBox.min_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
+    const int ex = Clamp((int)((localSpaceBox.max_.x_ - boundingBox_.min_.x_) / tileEdgeLength), 0, numTilesX_ - 1);
+    const int ez = Clamp((int)((localSpaceBox.max_.z_ - boundingBox_.min_.z_) / tileEdgeLength), 0, numTilesZ_ - 1);
+    return {IntVector2(sx, sz), IntVector2(ex, ez)};
+}
+
 ea::vector<unsigned char> NavigationMesh::GetTileData(const IntVector2& tile) const
 {
     VectorBuffer ret;
@@ -1271,19 +1424,23 @@ bool NavigationMesh::ReadTile(Deserializer& source, bool silent)
     return true;
 }
 
-bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z)
+ea::unique_ptr<NavBuildData> NavigationMesh::CreateTileBuildData() const
 {
-    URHO3D_PROFILE("BuildNavigationMeshTile");
-
-    // Remove previous tile (if any)
-    navMesh_->removeTile(navMesh_->getTileRefAt(x, z, 0), nullptr, nullptr);
+    return ea::make_unique<SimpleNavBuildData>();
+}
 
-    const BoundingBox tileBoundingBox = GetTileBoundingBox(IntVector2(x, z));
+ea::unique_ptr<NavBuildData> NavigationMesh::PrepareTileBuild(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& tile)
+{
+    const BoundingBox tileBoundingBox = GetTileBoundingBox(tile);
 
-    SimpleNavBuildData build;
+    ea::unique_ptr<NavBuildData> build = CreateTileBuildData();
+    build->tile_ = tile;
+    build->agentHeight_ = agentHeight_;
+    build->agentRadius_ = agentRadius_;
+    build->agentMaxClimb_ = agentMaxClimb_;
+    build->watershedPartition_ = partitionType_ == NAVMESH_PARTITION_WATERSHED;
 
-    rcConfig cfg;       // NOLINT(hicpp-member-init)
-    memset(&cfg, 0, sizeof cfg);
+    rcConfig& cfg = *build->config_;
     cfg.cs = cellSize_;
     cfg.ch = cellHeight_;
     cfg.walkableSlopeAngle = agentMaxSlope_;
@@ -1310,7 +1467,17 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
     cfg.bmax[2] += cfg.borderSize * cfg.cs;
 
     BoundingBox expandedBox(*reinterpret_cast<Vector3*>(cfg.bmin), *reinterpret_cast<Vector3*>(cfg.bmax));
-    GetTileGeometry(&build, geometryList, expandedBox);
+    GetTileGeometry(build.get(), geometryList, expandedBox);
+
+    return build;
+}
+
+bool NavigationMesh::BuildTileData(NavBuildData& buildData)
+{
+    URHO3D_PROFILE("BuildNavigationMeshTile");
+
+    auto& build = static_cast<SimpleNavBuildData&>(buildData);
+    const rcConfig* cfg = build.config_;
 
     if (build.vertices_.empty() || build.indices_.empty())
         return true; // Nothing to do
@@ -1322,8 +1489,8 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
         return false;
     }
 
-    if (!rcCreateHeightfield(build.ctx_, *build.heightField_, cfg.width, cfg.height, cfg.bmin, cfg.bmax, cfg.cs,
-        cfg.ch))
+    if (!rcCreateHeightfield(build.ctx_, *build.heightField_, cfg->width, cfg->height, cfg->bmin, cfg->bmax, cfg->cs,
+        cfg->ch))
     {
         URHO3D_LOGERROR("Could not create heightfield");
         return false;
@@ -1333,14 +1500,14 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
     ea::shared_array<unsigned char> triAreas(new unsigned char[numTriangles]);
     memset(triAreas.get(), 0, numTriangles);
 
-    rcMarkWalkableTriangles(build.ctx_, cfg.walkableSlopeAngle, &build.vertices_[0].x_, build.vertices_.size(),
+    rcMarkWalkableTriangles(build.ctx_, cfg->walkableSlopeAngle, &build.vertices_[0].x_, build.vertices_.size(),
         &build.indices_[0], numTriangles, triAreas.get());
     rcRasterizeTriangles(build.ctx_, &build.vertices_[0].x_, build.vertices_.size(), &build.indices_[0],
-        triAreas.get(), numTriangles, *build.heightField_, cfg.walkableClimb);
-    rcFilterLowHangingWalkableObstacles(build.ctx_, cfg.walkableClimb, *build.heightField_);
+        triAreas.get(), numTriangles, *build.heightField_, cfg->walkableClimb);
+    rcFilterLowHangingWalkableObstacles(build.ctx_, cfg->walkableClimb, *build.heightField_);
 
-    rcFilterWalkableLowHeightSpans(build.ctx_, cfg.walkableHeight, *build.heightField_);
-    rcFilterLedgeSpans(build.ctx_, cfg.walkableHeight, cfg.walkableClimb, *build.heightField_);
+    rcFilterWalkableLowHeightSpans(build.ctx_, cfg->walkableHeight, *build.heightField_);
+    rcFilterLedgeSpans(build.ctx_, cfg->walkableHeight, cfg->walkableClimb, *build.heightField_);
 
     build.compactHeightField_ = rcAllocCompactHeightfield();
     if (!build.compactHeightField_)
@@ -1348,13 +1515,13 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
         URHO3D_LOGERROR("Could not allocate create compact heightfield");
         return false;
     }
-    if (!rcBuildCompactHeightfield(build.ctx_, cfg.walkableHeight, cfg.walkableClimb, *build.heightField_,
+    if (!rcBuildCompactHeightfield(build.ctx_, cfg->walkableHeight, cfg->walkableClimb, *build.heightField_,
         *build.compactHeightField_))
     {
         URHO3D_LOGERROR("Could not build compact heightfield");
         return false;
     }
-    if (!rcErodeWalkableArea(build.ctx_, cfg.walkableRadius, *build.compactHeightField_))
+    if (!rcErodeWalkableArea(build.ctx_, cfg->walkableRadius, *build.compactHeightField_))
     {
         URHO3D_LOGERROR("Could not erode compact heightfield");
         return false;
@@ -1365,15 +1532,15 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
         rcMarkBoxArea(build.ctx_, &build.navAreas_[i].bounds_.min_.x_, &build.navAreas_[i].bounds_.max_.x_,
             build.navAreas_[i].areaID_, *build.compactHeightField_);
 
-    if (this->partitionType_ == NAVMESH_PARTITION_WATERSHED)
+    if (build.watershedPartition_)
     {
         if (!rcBuildDistanceField(build.ctx_, *build.compactHeightField_))
         {
             URHO3D_LOGERROR("Could not build distance field");
             return false;
         }
-        if (!rcBuildRegions(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.minRegionArea,
-            cfg.mergeRegionArea))
+        if (!rcBuildRegions(build.ctx_, *build.compactHeightField_, cfg->borderSize, cfg->minRegionArea,
+            cfg->mergeRegionArea))
         {
             URHO3D_LOGERROR("Could not build regions");
             return false;
@@ -1381,7 +1548,7 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
     }
     else
     {
-        if (!rcBuildRegionsMonotone(build.ctx_, *build.compactHeightField_, cfg.borderSize, cfg.minRegionArea, cfg.mergeRegionArea))
+        if (!rcBuildRegionsMonotone(build.ctx_, *build.compactHeightField_, cfg->borderSize, cfg->minRegionArea, cfg->mergeRegionArea))
         {
             URHO3D_LOGERROR("Could not build monotone regions");
             return false;
@@ -1394,7 +1561,7 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
         URHO3D_LOGERROR("Could not allocate contour set");
         return false;
     }
-    if (!rcBuildContours(build.ctx_, *build.compactHeightField_, cfg.maxSimplificationError, cfg.maxEdgeLen,
+    if (!rcBuildContours(build.ctx_, *build.compactHeightField_, cfg->maxSimplificationError, cfg->maxEdgeLen,
         *build.contourSet_))
     {
         URHO3D_LOGERROR("Could not create contours");
@@ -1407,7 +1574,7 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
         URHO3D_LOGERROR("Could not allocate poly mesh");
         return false;
     }
-    if (!rcBuildPolyMesh(build.ctx_, *build.contourSet_, cfg.maxVertsPerPoly, *build.polyMesh_))
+    if (!rcBuildPolyMesh(build.ctx_, *build.contourSet_, cfg->maxVertsPerPoly, *build.polyMesh_))
     {
         URHO3D_LOGERROR("Could not triangulate contours");
         return false;
@@ -1419,8 +1586,8 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
         URHO3D_LOGERROR("Could not allocate detail mesh");
         return false;
     }
-    if (!rcBuildPolyMeshDetail(build.ctx_, *build.polyMesh_, *build.compactHeightField_, cfg.detailSampleDist,
-        cfg.detailSampleMaxError, *build.polyMeshDetail_))
+    if (!rcBuildPolyMeshDetail(build.ctx_, *build.polyMesh_, *build.compactHeightField_, cfg->detailSampleDist,
+        cfg->detailSampleMaxError, *build.polyMeshDetail_))
     {
         URHO3D_LOGERROR("Could not build detail mesh");
         return false;
@@ -1451,15 +1618,15 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
     params.detailVertsCount = build.polyMeshDetail_->nverts;
     params.detailTris = build.polyMeshDetail_->tris;
     params.detailTriCount = build.polyMeshDetail_->ntris;
-    params.walkableHeight = agentHeight_;
-    params.walkableRadius = agentRadius_;
-    params.walkableClimb = agentMaxClimb_;
-    params.tileX = x;
-    params.tileY = z;
+    params.walkableHeight = build.agentHeight_;
+    params.walkableRadius = build.agentRadius_;
+    params.walkableClimb = build.agentMaxClimb_;
+    params.tileX = build.tile_.x_;
+    params.tileY = build.tile_.y_;
     rcVcopy(params.bmin, build.polyMesh_->bmin);
     rcVcopy(params.bmax, build.polyMesh_->bmax);
-    params.cs = cfg.cs;
-    params.ch = cfg.ch;
+    params.cs = cfg->cs;
+    params.ch = cfg->ch;
     params.buildBvTree = true;
 
     // Add off-mesh connections if have them
@@ -1479,15 +1646,33 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
         return false;
     }
 
-    if (dtStatusFailed(navMesh_->addTile(navData, navDataSize, DT_TILE_FREE_DATA, 0, nullptr)))
+    build.tileData_.push_back(NavTileData{navData, navDataSize});
+    return true;
+}
+
+unsigned NavigationMesh::AddTileData(NavBuildData& build)
+{
+    const IntVector2& tile = build.tile_;
+
+    // Remove previous tile (if any)
+    navMesh_->removeTile(navMesh_->getTileRefAt(tile.x_, tile.y_, 0), nullptr, nullptr);
+
+    for (NavTileData& tileData : build.tileData_)
     {
-        URHO3D_LOGERROR("Failed to add navigation mesh tile");
-        dtFree(navData);
-        return false;
+        if (dtStatusFailed(navMesh_->addTile(tileData.data_, tileData.dataSize_, DT_TILE_FREE_DATA, 0, nullptr)))
+        {
+            URHO3D_LOGERROR("Failed to add navigation mesh tile");
+            return 0;
+        }
+        // Navigation mesh owns the data now
+        tileData.data_ = nullptr;
     }
 
     // Send a notification of the rebuild of this tile to anyone interested
+    if (!build.tileData_.empty())
     {
+        const BoundingBox tileBoundingBox = GetTileBoundingBox(tile);
+
         using namespace NavigationAreaRebuilt;
         VariantMap& eventData = GetContext()->GetEventDataMap();
         eventData[P_NODE] = GetNode();
@@ -1496,19 +1681,53 @@ bool NavigationMesh::BuildTile(ea::vector<NavigationGeometryInfo>& geometryList,
         eventData[P_BOUNDSMAX] = Variant(tileBoundingBox.max_);
         SendEvent(E_NAVIGATION_AREA_REBUILT, eventData);
     }
-    return true;
+    return 1;
 }
 
 unsigned NavigationMesh::BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to)
 {
-    unsigned numTiles = 0;
-
+    ea::vector<IntVector2> tiles;
     for (int z = from.y_; z <= to.y_; ++z)
     {
         for (int x = from.x_; x <= to.x_; ++x)
+            tiles.emplace_back(x, z);
+    }
+
+    auto workQueue = GetSubsystem<WorkQueue>();
+    const TileBuildFunction buildFunction = GetTileBuildFunction();
+    const unsigned numThreads = workQueue ? workQueue->GetNumProcessingThreads() : 1;
+    // Geometry is gathered and tiles are added in batches to keep memory usage bounded
+    const unsigned batchSize = ea::max(1u, numThreads) * 4;
+
+    unsigned numTiles = 0;
+    ea::vector<ea::unique_ptr<NavBuildData>> batch;
+    ea::vector<unsigned char> batchResults;
+    for (unsigned batchStart = 0; batchStart < tiles.size(); batchStart += batchSize)
+    {
+        const unsigned batchEnd = ea::min(batchStart + batchSize, tiles.size());
+        const unsigned numBatchTiles = batchEnd - batchStart;
+
+        batch.clear();
+        for (unsigned i = batchStart; i < batchEnd; ++i)
+            batch.push_back(PrepareTileBuild(geometryList, tiles[i]));
+
+        batchResults.clear();
+        batchResults.resize(numBatchTiles, 0);
+        const auto buildTiles = [&](unsigned begin, unsigned end)
         {
-            if (BuildTile(geometryList, x, z))
-                ++numTiles;
+            for (unsigned i = begin; i < end; ++i)
+                batchResults[i] = buildFunction(*batch[i]);
+        };
+
+        if (workQueue)
+            ForEachParallel(workQueue, 1, numBatchTiles, buildTiles);
+        else
+            buildTiles(0, numBatchTiles);
+
+        for (unsigned i = 0; i < numBatchTiles; ++i)
+        {
+            if (batchResults[i])
+                numTiles += AddTileData(*batch[i]);
         }
     }
     return numTiles;
@@ -1540,6 +1759,8 @@ bool NavigationMesh::InitializeQuery()
 
 void NavigationMesh::ReleaseNavigationMesh()
 {
+    CancelAsyncBuild();
+
     dtFreeNavMesh(navMesh_);
     navMesh_ = nullptr;
 
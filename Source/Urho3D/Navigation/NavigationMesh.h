@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include <EASTL/shared_ptr.h>
 #include <EASTL/unique_ptr.h>
 #include <EASTL/unordered_set.h>
 
@@ -160,6 +161,18 @@ public:
     virtual bool Build(const BoundingBox& boundingBox);
     /// Rebuild part of the navigation mesh in the rectangular area. Return true if successful.
     virtual bool Build(const IntVector2& from, const IntVector2& to);
+    /// Start rebuilding part of the navigation mesh contained by the world-space bounding box.
+    /// Tiles are built in worker threads and added to the navigation mesh on the main thread during next frames.
+    /// Asynchronous build in progress is cancelled. Return true if started.
+    bool BuildAsync(const BoundingBox& boundingBox);
+    /// Start rebuilding part of the navigation mesh in the rectangular area. Return true if started.
+    bool BuildAsync(const IntVector2& from, const IntVector2& to);
+    /// Cancel asynchronous build. Tiles that are already rebuilt are kept.
+    void CancelAsyncBuild();
+    /// Return whether asynchronous build is in progress.
+    bool IsAsyncBuildInProgress() const { return asyncBuild_ != nullptr; }
+    /// Return progress of asynchronous build from 0 to 1. Return 1 if there's no build in progress.
+    float GetAsyncBuildProgress() const;
     /// Return tile data.
     virtual ea::vector<unsigned char> GetTileData(const IntVector2& tile) const;
     /// Add tile to navigation mesh.
@@ -319,6 +332,16 @@ private:
     void WriteTile(Serializer& dest, int x, int z) const;
     /// Read tile data to the navigation mesh.
     bool ReadTile(Deserializer& source, bool silent);
+    /// Dispatch tiles of asynchronous build to worker threads.
+    void DispatchAsyncBuildTiles();
+    /// Add tile of asynchronous build to the navigation mesh.
+    void FinishAsyncBuildTile();
+    /// Return range of tiles intersecting the world-space bounding box.
+    ea::pair<IntVector2, IntVector2> GetTileRange(const BoundingBox& boundingBox) const;
+
+    struct AsyncBuildState;
+    /// State of asynchronous build in progress.
+    ea::shared_ptr<AsyncBuildState> asyncBuild_;
 
 protected:
     /// Collect geometry from under Navigable components.
@@ -329,10 +352,20 @@ protected:
     void GetTileGeometry(NavBuildData* build, ea::vector<NavigationGeometryInfo>& geometryList, BoundingBox& box);
     /// Add a triangle mesh to the geometry data.
     void AddTriMeshGeometry(NavBuildData* build, Geometry* geometry, const Matrix3x4& transform);
-    /// Build one tile of the navigation mesh. Return true if successful.
-    virtual bool BuildTile(ea::vector<NavigationGeometryInfo>& geometryList, int x, int z);
-    /// Build tiles in the rectangular area. Return number of built tiles.
+    /// Function that builds tile data from build data. Must not access anything except build data.
+    using TileBuildFunction = bool(*)(NavBuildData& build);
+    /// Create empty build data of the tile.
+    virtual ea::unique_ptr<NavBuildData> CreateTileBuildData() const;
+    /// Return function that builds tile data. Called from worker threads.
+    virtual TileBuildFunction GetTileBuildFunction() const { return &NavigationMesh::BuildTileData; }
+    /// Replace tile in the navigation mesh with built tile data. Return number of added tiles.
+    virtual unsigned AddTileData(NavBuildData& build);
+    /// Prepare configuration and geometry of one tile for building in worker thread.
+    ea::unique_ptr<NavBuildData> PrepareTileBuild(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& tile);
+    /// Build tiles in the rectangular area using worker threads. Return number of built tiles.
     unsigned BuildTiles(ea::vector<NavigationGeometryInfo>& geometryList, const IntVector2& from, const IntVector2& to);
+    /// Build navigation mesh tile from prepared build data. Return true if successful.
+    static bool BuildTileData(NavBuildData& build);
     /// Ensure that the navigation mesh query is initialized. Return true if successful.
     bool InitializeQuery();
     /// Release the navigation mesh and the query.
@@ -30,8 +30,10 @@
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
 #include "../IO/VectorBuffer.h"
+#include "../Network/NetworkStatistics.h"
 #include "../Network/Protocol.h"
 
+#include <EASTL/unique_ptr.h>
 #include <EASTL/unordered_set.h>
 
 namespace Urho3D
@@ -72,11 +74,27 @@ public:
     /// Return ping of the connection.
     virtual unsigned GetPing() const = 0;
 
+    /// Enable or disable collection of outgoing traffic statistics.
+    void SetTrafficStatisticsEnabled(bool enable)
+    {
+        if (!enable)
+            statistics_ = nullptr;
+        else if (!statistics_)
+            statistics_ = ea::make_unique<NetworkStatistics>();
+    }
+    /// Return whether outgoing traffic statistics are collected.
+    bool IsTrafficStatisticsEnabled() const { return statistics_ != nullptr; }
+    /// Return outgoing traffic statistics, if enabled.
+    /// @nobind
+    NetworkStatistics* GetTrafficStatistics() const { return statistics_.get(); }
+
     /// Syntax sugar for SendMessage
     /// @{
     void SendLoggedMessage(NetworkMessageId messageId, bool reliable, bool inOrder, const unsigned char* data, unsigned numBytes, ea::string_view debugInfo = {})
     {
         SendMessageInternal(messageId, reliable, inOrder, data, numBytes);
+        if (statistics_)
+            statistics_->RecordMessage(messageId, reliable, numBytes);
 
         Log::GetLogger().Write(GetMessageLogLevel(messageId), "{}: Message #{} ({} bytes) sent{}{}{}{}",
             ToString(),
@@ -172,6 +190,8 @@ public:
 protected:
     /// Reusable message buffer.
     VectorBuffer msg_;
+    /// Outgoing traffic statistics.
+    ea::unique_ptr<NetworkStatistics> statistics_;
 };
 
 }
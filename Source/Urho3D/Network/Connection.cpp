@@ -103,6 +103,7 @@ void Connection::Initialize(bool isClient, const SLNet::AddressOrGUID& address,
     auto network = GetSubsystem<Network>();
     clock_ = ea::make_unique<ClockSynchronizer>(network->GetPingIntervalMs(), network->GetMaxPingIntervalMs(),
         network->GetClockBufferSize(), network->GetPingBufferSize());
+    SetTrafficStatisticsEnabled(network->IsTrafficStatisticsEnabled());
 }
 
 void Connection::RegisterObject(Context* context)
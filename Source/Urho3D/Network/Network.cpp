@@ -570,6 +570,32 @@ void Network::SetSimulatedPacketLoss(float probability)
     ConfigureNetworkSimulator();
 }
 
+void Network::SetTrafficStatisticsEnabled(bool enable)
+{
+    trafficStatisticsEnabled_ = enable;
+
+    if (serverConnection_)
+        serverConnection_->SetTrafficStatisticsEnabled(enable);
+    for (const auto& [endpoint, connection] : clientConnections_)
+        connection->SetTrafficStatisticsEnabled(enable);
+}
+
+NetworkStatistics Network::GetTrafficStatistics() const
+{
+    NetworkStatistics result;
+    if (serverConnection_)
+    {
+        if (const NetworkStatistics* statistics = serverConnection_->GetTrafficStatistics())
+            result.Merge(*statistics);
+    }
+    for (const auto& [endpoint, connection] : clientConnections_)
+    {
+        if (const NetworkStatistics* statistics = connection->GetTrafficStatistics())
+            result.Merge(*statistics);
+    }
+    return result;
+}
+
 void Network::RegisterRemoteEvent(StringHash eventType)
 {
     allowedRemoteEvents_.insert(eventType);
@@ -101,6 +101,8 @@ public:
     /// Set simulated packet loss probability between 0.0 - 1.0.
     /// @property
     void SetSimulatedPacketLoss(float probability);
+    /// Enable or disable collection of outgoing traffic statistics for all current and future connections.
+    void SetTrafficStatisticsEnabled(bool enable);
     /// Test only. Set whether to send events as server.
     void SetSimulateServerEvents(bool enable) { simulateServerEvents_ = enable; }
     /// Test only. Set whether to send events as client.
@@ -145,6 +147,11 @@ public:
 
     /// Return whether the network is updated on this frame.
     bool IsUpdateNow() const { return updateNow_; }
+    /// Return whether outgoing traffic statistics are collected.
+    bool IsTrafficStatisticsEnabled() const { return trafficStatisticsEnabled_; }
+    /// Return outgoing traffic statistics of all connections merged together.
+    /// @nobind
+    NetworkStatistics GetTrafficStatistics() const;
 
     /// Return a client or server connection by RakNet connection address, or null if none exist.
     Connection* GetConnection(const SLNet::AddressOrGUID& connection) const;
@@ -189,6 +196,9 @@ private:
 
     void SendNetworkUpdateEvent(StringHash eventType, bool isServer);
 
+    /// Whether to collect outgoing traffic statistics.
+    bool trafficStatisticsEnabled_{};
+
     /// Used for testing only
     /// @{
     bool simulateServerEvents_{};
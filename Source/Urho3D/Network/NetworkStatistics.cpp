@@ -0,0 +1,238 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Format.h"
+#include "../IO/Serializer.h"
+#include "../Network/NetworkStatistics.h"
+#include "../Replica/NetworkObject.h"
+#include "../Scene/Node.h"
+
+#include <EASTL/sort.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+const char* categoryNames[] = {"Message", "Object", "Component"};
+
+ea::string EscapeCSV(const ea::string& value)
+{
+    if (!value.contains(',') && !value.contains('"'))
+        return value;
+
+    ea::string result = value;
+    result.replace("\"", "\"\"");
+    return Format("\"{}\"", result);
+}
+
+}
+
+void NetworkTrafficCounters::Add(bool reliable, unsigned numBytes)
+{
+    if (reliable)
+    {
+        ++numReliableMessages_;
+        numReliableBytes_ += numBytes;
+    }
+    else
+    {
+        ++numUnreliableMessages_;
+        numUnreliableBytes_ += numBytes;
+    }
+}
+
+NetworkTrafficCounters& NetworkTrafficCounters::operator+=(const NetworkTrafficCounters& rhs)
+{
+    numReliableMessages_ += rhs.numReliableMessages_;
+    numUnreliableMessages_ += rhs.numUnreliableMessages_;
+    numReliableBytes_ += rhs.numReliableBytes_;
+    numUnreliableBytes_ += rhs.numUnreliableBytes_;
+    return *this;
+}
+
+template <class T>
+NetworkTrafficCounters& NetworkStatistics::GetCurrentCounters(
+    NetworkTrafficCategory category, unsigned key, const T& getName)
+{
+    Category& data = categories_[static_cast<unsigned>(category)];
+
+    // Names are evaluated once per entry because they may be expensive to build
+    const auto iter = data.samples_.find(key);
+    if (iter == data.samples_.end())
+        data.samples_[key].name_ = getName();
+
+    return data.currentFrame_[key];
+}
+
+void NetworkStatistics::RecordMessage(NetworkMessageId messageId, bool reliable, unsigned numBytes)
+{
+    const auto getName = [&] { return Format("Message #{}", static_cast<unsigned>(messageId)); };
+    GetCurrentCounters(NetworkTrafficCategory::Message, messageId, getName).Add(reliable, numBytes);
+}
+
+void NetworkStatistics::RecordObject(NetworkObject* networkObject, bool reliable, unsigned numBytes,
+    unsigned rawSize, const NetworkComponentTrafficVector& componentTraffic)
+{
+    const auto getObjectName = [&]
+    {
+        Node* node = networkObject->GetNode();
+        return Format("{} '{}'", Urho3D::ToString(networkObject->GetNetworkId()), node ? node->GetName() : EMPTY_STRING);
+    };
+    const auto objectKey = static_cast<unsigned>(networkObject->GetNetworkId());
+    GetCurrentCounters(NetworkTrafficCategory::Object, objectKey, getObjectName).Add(reliable, numBytes);
+
+    // Delta compression may make sent data smaller than raw data, never scale up
+    const float scale = rawSize > numBytes ? static_cast<float>(numBytes) / rawSize : 1.0f;
+    unsigned remainingBytes = numBytes;
+    for (const NetworkComponentTraffic& traffic : componentTraffic)
+    {
+        const unsigned componentBytes = ea::min(remainingBytes, static_cast<unsigned>(RoundToInt(traffic.numBytes_ * scale)));
+        remainingBytes -= componentBytes;
+
+        const auto getComponentName = [&] { return traffic.typeName_ ? *traffic.typeName_ : traffic.type_.ToDebugString(); };
+        GetCurrentCounters(NetworkTrafficCategory::Component, traffic.type_.Value(), getComponentName)
+            .Add(reliable, componentBytes);
+    }
+
+    const auto getObjectTypeName = [&] { return networkObject->GetTypeName(); };
+    GetCurrentCounters(NetworkTrafficCategory::Component, networkObject->GetType().Value(), getObjectTypeName)
+        .Add(reliable, remainingBytes);
+}
+
+void NetworkStatistics::EndFrame(float timeStep)
+{
+    const float smoothing = timeStep > 0.0f ? ea::min(1.0f, timeStep / SmoothingWindow) : 1.0f;
+    for (Category& category : categories_)
+    {
+        for (auto& [key, sample] : category.samples_)
+        {
+            const auto iter = category.currentFrame_.find(key);
+            sample.lastFrame_ = iter != category.currentFrame_.end() ? iter->second : NetworkTrafficCounters{};
+            sample.total_ += sample.lastFrame_;
+
+            const float frameBytesPerSecond = timeStep > 0.0f ? sample.lastFrame_.GetNumBytes() / timeStep : 0.0f;
+            sample.bytesPerSecond_ = Lerp(sample.bytesPerSecond_, frameBytesPerSecond, smoothing);
+        }
+        category.currentFrame_.clear();
+    }
+    ++numFrames_;
+}
+
+void NetworkStatistics::Merge(const NetworkStatistics& other)
+{
+    for (unsigned i = 0; i < static_cast<unsigned>(NetworkTrafficCategory::Count); ++i)
+    {
+        for (const auto& [key, otherSample] : other.categories_[i].samples_)
+        {
+            NetworkTrafficSample& sample = categories_[i].samples_[key];
+            if (sample.name_.empty())
+                sample.name_ = otherSample.name_;
+            sample.lastFrame_ += otherSample.lastFrame_;
+            sample.total_ += otherSample.total_;
+            sample.bytesPerSecond_ += otherSample.bytesPerSecond_;
+        }
+    }
+    numFrames_ = ea::max(numFrames_, other.numFrames_);
+}
+
+void NetworkStatistics::Reset()
+{
+    for (Category& category : categories_)
+    {
+        category.samples_.clear();
+        category.currentFrame_.clear();
+    }
+    numFrames_ = 0;
+}
+
+const ea::unordered_map<unsigned, NetworkTrafficSample>& NetworkStatistics::GetSamples(
+    NetworkTrafficCategory category) const
+{
+    return categories_[static_cast<unsigned>(category)].samples_;
+}
+
+ea::vector<const NetworkTrafficSample*> NetworkStatistics::GetSortedSamples(
+    NetworkTrafficCategory category, unsigned maxCount) const
+{
+    ea::vector<const NetworkTrafficSample*> result;
+    for (const auto& [key, sample] : GetSamples(category))
+        result.push_back(&sample);
+
+    const auto isGreater = [](const NetworkTrafficSample* lhs, const NetworkTrafficSample* rhs)
+    {
+        if (lhs->bytesPerSecond_ != rhs->bytesPerSecond_)
+            return lhs->bytesPerSecond_ > rhs->bytesPerSecond_;
+        return lhs->total_.GetNumBytes() > rhs->total_.GetNumBytes();
+    };
+    ea::sort(result.begin(), result.end(), isGreater);
+
+    if (result.size() > maxCount)
+        result.resize(maxCount);
+    return result;
+}
+
+ea::string NetworkStatistics::ToString(unsigned maxEntries) const
+{
+    ea::string result;
+    for (unsigned i = 0; i < static_cast<unsigned>(NetworkTrafficCategory::Count); ++i)
+    {
+        const auto category = static_cast<NetworkTrafficCategory>(i);
+        const auto samples = GetSortedSamples(category, maxEntries);
+        if (samples.empty())
+            continue;
+
+        result += Format("{}:\n", categoryNames[i]);
+        for (const NetworkTrafficSample* sample : samples)
+        {
+            result += Format("  {}: {:.1f} KB/s, {} msg/frame (R {} / U {} bytes total)\n", sample->name_,
+                sample->bytesPerSecond_ / 1024.0f, sample->lastFrame_.GetNumMessages(), sample->total_.numReliableBytes_,
+                sample->total_.numUnreliableBytes_);
+        }
+    }
+    return result;
+}
+
+void NetworkStatistics::WriteCSV(Serializer& dest) const
+{
+    dest.WriteLine("Category,Name,ReliableMessages,UnreliableMessages,ReliableBytes,UnreliableBytes,"
+        "LastFrameBytes,BytesPerSecond");
+
+    for (unsigned i = 0; i < static_cast<unsigned>(NetworkTrafficCategory::Count); ++i)
+    {
+        const auto category = static_cast<NetworkTrafficCategory>(i);
+        for (const NetworkTrafficSample* sample : GetSortedSamples(category))
+        {
+            dest.WriteLine(Format("{},{},{},{},{},{},{},{:.1f}", categoryNames[i], EscapeCSV(sample->name_),
+                sample->total_.numReliableMessages_, sample->total_.numUnreliableMessages_,
+                sample->total_.numReliableBytes_, sample->total_.numUnreliableBytes_,
+                sample->lastFrame_.GetNumBytes(), sample->bytesPerSecond_));
+        }
+    }
+}
+
+}
@@ -0,0 +1,141 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/// \file
+
+#pragma once
+
+#include "../Container/Str.h"
+#include "../Math/MathDefs.h"
+#include "../Math/StringHash.h"
+#include "../Network/Protocol.h"
+
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class NetworkObject;
+class Serializer;
+
+/// Category of network traffic statistics.
+enum class NetworkTrafficCategory
+{
+    /// Breakdown by NetworkMessageId.
+    Message,
+    /// Breakdown by individual NetworkObject.
+    Object,
+    /// Breakdown by type of NetworkBehavior or NetworkObject.
+    Component,
+    Count
+};
+
+/// Counters of network traffic.
+struct URHO3D_API NetworkTrafficCounters
+{
+    unsigned numReliableMessages_{};
+    unsigned numUnreliableMessages_{};
+    unsigned long long numReliableBytes_{};
+    unsigned long long numUnreliableBytes_{};
+
+    void Add(bool reliable, unsigned numBytes);
+    NetworkTrafficCounters& operator+=(const NetworkTrafficCounters& rhs);
+
+    unsigned GetNumMessages() const { return numReliableMessages_ + numUnreliableMessages_; }
+    unsigned long long GetNumBytes() const { return numReliableBytes_ + numUnreliableBytes_; }
+};
+
+/// Traffic statistics of single entry, e.g. single message type or single NetworkObject.
+struct URHO3D_API NetworkTrafficSample
+{
+    /// Human-readable name of the entry.
+    ea::string name_;
+    /// Traffic during the latest complete network frame.
+    NetworkTrafficCounters lastFrame_;
+    /// Total traffic since statistics were enabled.
+    NetworkTrafficCounters total_;
+    /// Smoothed traffic in bytes per second.
+    float bytesPerSecond_{};
+};
+
+/// Size of data written by the component of NetworkObject. Used for traffic statistics.
+struct NetworkComponentTraffic
+{
+    StringHash type_;
+    const ea::string* typeName_{};
+    unsigned numBytes_{};
+};
+
+using NetworkComponentTrafficVector = ea::vector<NetworkComponentTraffic>;
+
+/// Outgoing traffic statistics of the connection,
+/// broken down by message type, NetworkObject and NetworkBehavior type.
+/// Counters are accumulated during network frame and sampled by EndFrame.
+/// @nobind
+class URHO3D_API NetworkStatistics
+{
+public:
+    /// Time window for smoothing of bytes per second.
+    static constexpr float SmoothingWindow = 1.0f;
+
+    /// Record outgoing message.
+    void RecordMessage(NetworkMessageId messageId, bool reliable, unsigned numBytes);
+    /// Record update of NetworkObject.
+    /// Raw data of components may be compressed before sending, so sent bytes are attributed to components
+    /// proportionally to raw data size. The rest is attributed to the type of NetworkObject itself.
+    void RecordObject(NetworkObject* networkObject, bool reliable, unsigned numBytes, unsigned rawSize,
+        const NetworkComponentTrafficVector& componentTraffic);
+    /// Sample counters of the current frame and start new frame.
+    void EndFrame(float timeStep);
+    /// Add samples of other statistics, e.g. to aggregate all connections.
+    void Merge(const NetworkStatistics& other);
+    /// Reset all counters.
+    void Reset();
+
+    /// Return all samples in category.
+    const ea::unordered_map<unsigned, NetworkTrafficSample>& GetSamples(NetworkTrafficCategory category) const;
+    /// Return samples in category sorted by bytes per second, from highest to lowest.
+    ea::vector<const NetworkTrafficSample*> GetSortedSamples(NetworkTrafficCategory category, unsigned maxCount = M_MAX_UNSIGNED) const;
+    /// Return number of sampled frames.
+    unsigned GetNumFrames() const { return numFrames_; }
+
+    /// Return human-readable summary with top entries of each category.
+    ea::string ToString(unsigned maxEntries = 5) const;
+    /// Write all samples as CSV table.
+    void WriteCSV(Serializer& dest) const;
+
+private:
+    struct Category
+    {
+        ea::unordered_map<unsigned, NetworkTrafficSample> samples_;
+        ea::unordered_map<unsigned, NetworkTrafficCounters> currentFrame_;
+    };
+
+    template <class T>
+    NetworkTrafficCounters& GetCurrentCounters(NetworkTrafficCategory category, unsigned key, const T& getName);
+
+    Category categories_[static_cast<unsigned>(NetworkTrafficCategory::Count)];
+    unsigned numFrames_{};
+};
+
+}
@@ -70,6 +70,8 @@ enum NetworkMessageId
     MSG_UPDATE_OBJECTS_UNRELIABLE,
     /// Client->Server. ReplicationManager message. Perform unordered and unreliable update of owned NetworkObjects from client to server.
     MSG_OBJECTS_FEEDBACK_UNRELIABLE,
+    /// Client->Server. ReplicationManager message. Acknowledge delivered unreliable updates of NetworkObjects.
+    MSG_UPDATE_OBJECTS_ACK,
 
     /// Message IDs starting from MSG_USER are reserved for the end user.
     MSG_USER = 512
@@ -0,0 +1,1038 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Thread.h"
+#include "../Core/Timer.h"
+#include "../IO/Log.h"
+#include "../Network/ClockSynchronizer.h"
+#include "../Network/Network.h"
+#include "../Network/UdpTransport.h"
+
+#ifdef _WIN32
+    #include <winsock2.h>
+    #include <ws2tcpip.h>
+#else
+    #include <arpa/inet.h>
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <netinet/in.h>
+    #include <poll.h>
+    #include <sys/socket.h>
+    #include <unistd.h>
+#endif
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+const SocketHandle invalidSocket = INVALID_SOCKET;
+#else
+using SocketHandle = int;
+const SocketHandle invalidSocket = -1;
+#endif
+
+/// Magic number sent with connection request to filter out unrelated traffic.
+const unsigned connectionMagic = 0x55445031;
+/// Interval between connection requests sent by client.
+const unsigned handshakeIntervalMs = 250;
+/// Interval of empty datagrams sent to keep connection alive.
+const unsigned keepAliveIntervalMs = 1000;
+/// Incomplete fragmented messages are discarded after this time.
+const unsigned fragmentTimeoutMs = 5000;
+/// Max number of fragments in one message.
+const unsigned maxFragments = 16384;
+/// Max number of datagrams received or sent in one system call.
+const unsigned ioBatchSize = 64;
+/// Max time I/O thread waits for incoming datagrams.
+const int ioWaitTimeoutMs = 1;
+/// Size of data datagram header: kind, sequence, acknowledged sequence and acknowledgement bits.
+const unsigned datagramHeaderSize = 9;
+/// Reserved space for message header in datagram.
+const unsigned maxMessageHeaderSize = 24;
+
+enum class DatagramKind : unsigned char
+{
+    Connect = 1,
+    Accept = 2,
+    Data = 3,
+    Disconnect = 4,
+};
+
+const unsigned char channelMask = 0x3;
+const unsigned char fragmentedFlag = 0x4;
+
+bool IsSequenceNewer(unsigned short lhs, unsigned short rhs)
+{
+    return lhs != rhs && static_cast<unsigned short>(lhs - rhs) < 0x8000;
+}
+
+bool IsReliable(PacketType channel)
+{
+    return channel == PT_RELIABLE_ORDERED || channel == PT_RELIABLE_UNORDERED;
+}
+
+void CloseSocket(SocketHandle socket)
+{
+#ifdef _WIN32
+    closesocket(socket);
+#else
+    close(socket);
+#endif
+}
+
+bool IsWouldBlockError()
+{
+#ifdef _WIN32
+    return WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
+
+sockaddr_in ToSocketAddress(const UdpEndpoint& endpoint)
+{
+    sockaddr_in result{};
+    result.sin_family = AF_INET;
+    result.sin_addr.s_addr = htonl(endpoint.address_);
+    result.sin_port = htons(endpoint.port_);
+    return result;
+}
+
+UdpEndpoint FromSocketAddress(const sockaddr_in& address)
+{
+    return UdpEndpoint{ntohl(address.sin_addr.s_addr), ntohs(address.sin_port)};
+}
+
+void WriteDatagramKind(VectorBuffer& dest, DatagramKind kind)
+{
+    dest.WriteUByte(static_cast<unsigned char>(kind));
+}
+
+}
+
+/// Owns the socket and exchanges batches of datagrams with the main thread.
+class UdpTransportThread : public Thread
+{
+public:
+    explicit UdpTransportThread(SocketHandle socket)
+        : Thread("UdpTransport")
+        , socket_(socket)
+    {
+    }
+
+    ~UdpTransportThread() override
+    {
+        Stop();
+        CloseSocket(socket_);
+    }
+
+    void ThreadFunction() override
+    {
+        ea::vector<UdpDatagram> incoming;
+        ea::vector<UdpDatagram> outgoing;
+        while (shouldRun_)
+        {
+            WaitForData();
+            ReceiveBatch(incoming);
+            if (!incoming.empty())
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                for (UdpDatagram& datagram : incoming)
+                    incoming_.push_back(ea::move(datagram));
+            }
+            incoming.clear();
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                outgoing.swap(outgoing_);
+            }
+            SendBatch(outgoing);
+            outgoing.clear();
+        }
+    }
+
+    /// Take all received datagrams. Safe to call from any thread.
+    void PopIncoming(ea::vector<UdpDatagram>& dest)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        dest.swap(incoming_);
+        incoming_.clear();
+    }
+
+    /// Queue datagrams for sending. Safe to call from any thread.
+    void PushOutgoing(ea::vector<UdpDatagram>& datagrams)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (UdpDatagram& datagram : datagrams)
+            outgoing_.push_back(ea::move(datagram));
+        datagrams.clear();
+    }
+
+private:
+    void WaitForData()
+    {
+#ifdef _WIN32
+        fd_set readSet;
+        FD_ZERO(&readSet);
+        FD_SET(socket_, &readSet);
+        timeval timeout{0, ioWaitTimeoutMs * 1000};
+        select(0, &readSet, nullptr, nullptr, &timeout);
+#else
+        pollfd fd{socket_, POLLIN, 0};
+        poll(&fd, 1, ioWaitTimeoutMs);
+#endif
+    }
+
+    void ReceiveBatch(ea::vector<UdpDatagram>& dest)
+    {
+#ifdef __linux__
+        // Receive up to ioBatchSize datagrams per system call
+        while (true)
+        {
+            mmsghdr headers[ioBatchSize]{};
+            iovec buffers[ioBatchSize]{};
+            sockaddr_in addresses[ioBatchSize]{};
+            for (unsigned i = 0; i < ioBatchSize; ++i)
+            {
+                buffers[i].iov_base = receiveBuffers_[i];
+                buffers[i].iov_len = sizeof(receiveBuffers_[i]);
+                headers[i].msg_hdr.msg_iov = &buffers[i];
+                headers[i].msg_hdr.msg_iovlen = 1;
+                headers[i].msg_hdr.msg_name = &addresses[i];
+                headers[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+            }
+
+            const int numReceived = recvmmsg(socket_, headers, ioBatchSize, MSG_DONTWAIT, nullptr);
+            if (numReceived <= 0)
+                break;
+
+            for (int i = 0; i < numReceived; ++i)
+            {
+                const auto data = static_cast<const unsigned char*>(buffers[i].iov_base);
+                dest.push_back(UdpDatagram{FromSocketAddress(addresses[i]), ByteVector(data, data + headers[i].msg_len)});
+            }
+
+            if (numReceived < static_cast<int>(ioBatchSize))
+                break;
+        }
+#else
+        while (true)
+        {
+            sockaddr_in address{};
+            socklen_t addressLength = sizeof(address);
+            const int numBytes = recvfrom(socket_, reinterpret_cast<char*>(receiveBuffers_[0]),
+                sizeof(receiveBuffers_[0]), 0, reinterpret_cast<sockaddr*>(&address), &addressLength);
+            if (numBytes < 0)
+            {
+            #ifdef _WIN32
+                // Windows reports ICMP errors of previous sends here, they should not stop the receiving
+                if (WSAGetLastError() == WSAECONNRESET)
+                    continue;
+            #endif
+                break;
+            }
+
+            const unsigned char* data = receiveBuffers_[0];
+            dest.push_back(UdpDatagram{FromSocketAddress(address), ByteVector(data, data + numBytes)});
+        }
+#endif
+    }
+
+    void SendBatch(const ea::vector<UdpDatagram>& datagrams)
+    {
+#ifdef __linux__
+        // Send up to ioBatchSize datagrams per system call
+        for (unsigned first = 0; first < datagrams.size(); first += ioBatchSize)
+        {
+            const unsigned count = ea::min<unsigned>(ioBatchSize, datagrams.size() - first);
+            mmsghdr headers[ioBatchSize]{};
+            iovec buffers[ioBatchSize]{};
+            sockaddr_in addresses[ioBatchSize]{};
+            for (unsigned i = 0; i < count; ++i)
+            {
+                const UdpDatagram& datagram = datagrams[first + i];
+                addresses[i] = ToSocketAddress(datagram.endpoint_);
+                buffers[i].iov_base = const_cast<unsigned char*>(datagram.data_.data());
+                buffers[i].iov_len = datagram.data_.size();
+                headers[i].msg_hdr.msg_iov = &buffers[i];
+                headers[i].msg_hdr.msg_iovlen = 1;
+                headers[i].msg_hdr.msg_name = &addresses[i];
+                headers[i].msg_hdr.msg_namelen = sizeof(addresses[i]);
+            }
+
+            unsigned numSent = 0;
+            while (numSent < count)
+            {
+                const int result = sendmmsg(socket_, headers + numSent, count - numSent, 0);
+                if (result <= 0)
+                {
+                    // Datagrams may be lost anyway, drop the rest of the batch if socket buffer is full
+                    if (!IsWouldBlockError())
+                        URHO3D_LOGWARNING("Failed to send UDP datagrams: error {}", errno);
+                    break;
+                }
+                numSent += result;
+            }
+        }
+#else
+        for (const UdpDatagram& datagram : datagrams)
+        {
+            const sockaddr_in address = ToSocketAddress(datagram.endpoint_);
+            sendto(socket_, reinterpret_cast<const char*>(datagram.data_.data()), static_cast<int>(datagram.data_.size()),
+                0, reinterpret_cast<const sockaddr*>(&address), sizeof(address));
+        }
+#endif
+    }
+
+    const SocketHandle socket_;
+    std::mutex mutex_;
+    ea::vector<UdpDatagram> incoming_;
+    ea::vector<UdpDatagram> outgoing_;
+    unsigned char receiveBuffers_[ioBatchSize][UdpConnection::MaxDatagramSize];
+};
+
+ea::optional<UdpEndpoint> UdpEndpoint::FromString(const ea::string& address, unsigned short port)
+{
+    const ea::string& numericAddress = address == "localhost" ? ea::string{"127.0.0.1"} : address;
+
+    in_addr result{};
+    if (inet_pton(AF_INET, numericAddress.c_str(), &result) != 1)
+        return ea::nullopt;
+
+    return UdpEndpoint{ntohl(result.s_addr), port};
+}
+
+ea::string UdpEndpoint::ToString() const
+{
+    return Format("{}.{}.{}.{}:{}", (address_ >> 24) & 0xff, (address_ >> 16) & 0xff, (address_ >> 8) & 0xff,
+        address_ & 0xff, port_);
+}
+
+UdpConnection::UdpConnection(Context* context, UdpTransport* transport, const UdpEndpoint& endpoint, bool isClient)
+    : AbstractConnection(context)
+    , transport_(transport)
+    , endpoint_(endpoint)
+    , isClient_(isClient)
+    , state_(isClient ? UdpConnectionState::Connecting : UdpConnectionState::Connected)
+    , sentDatagrams_(SentDatagramHistory)
+{
+    channels_[PT_RELIABLE_UNORDERED].receivedSequences_.resize(ReceivedSequenceHistory);
+
+    if (auto network = GetSubsystem<Network>())
+    {
+        clock_ = ea::make_unique<ClockSynchronizer>(network->GetPingIntervalMs(), network->GetMaxPingIntervalMs(),
+            network->GetClockBufferSize(), network->GetPingBufferSize());
+    }
+    else
+        clock_ = ea::make_unique<ClockSynchronizer>(250, 10000, 40, 10);
+
+    lastReceiveTime_ = GetLocalTime();
+}
+
+UdpConnection::~UdpConnection() = default;
+
+void UdpConnection::SendMessageInternal(
+    NetworkMessageId messageId, bool reliable, bool inOrder, const unsigned char* data, unsigned numBytes)
+{
+    if (state_ == UdpConnectionState::Disconnected)
+        return;
+
+    const PacketType channel = reliable
+        ? (inOrder ? PT_RELIABLE_ORDERED : PT_RELIABLE_UNORDERED)
+        : (inOrder ? PT_UNRELIABLE_ORDERED : PT_UNRELIABLE_UNORDERED);
+    EnqueueMessage(channel, messageId, data, numBytes);
+}
+
+ea::string UdpConnection::ToString() const
+{
+    return Format("UDP connection #{} ({})", GetObjectID(), endpoint_.ToString());
+}
+
+bool UdpConnection::IsClockSynchronized() const
+{
+    return clock_->IsReady();
+}
+
+unsigned UdpConnection::RemoteToLocalTime(unsigned time) const
+{
+    return clock_->RemoteToLocal(time);
+}
+
+unsigned UdpConnection::LocalToRemoteTime(unsigned time) const
+{
+    return clock_->LocalToRemote(time);
+}
+
+unsigned UdpConnection::GetLocalTime() const
+{
+    return Time::GetSystemTime();
+}
+
+unsigned UdpConnection::GetLocalTimeOfLatestRoundtrip() const
+{
+    return clock_->GetLocalTimeOfLatestRoundtrip();
+}
+
+unsigned UdpConnection::GetPing() const
+{
+    return clock_->GetPing();
+}
+
+void UdpConnection::Disconnect()
+{
+    if (state_ == UdpConnectionState::Disconnected)
+        return;
+
+    state_ = UdpConnectionState::Disconnected;
+    if (transport_)
+    {
+        datagramBuffer_.Clear();
+        WriteDatagramKind(datagramBuffer_, DatagramKind::Disconnect);
+        transport_->outgoingDatagrams_.push_back(UdpDatagram{endpoint_, datagramBuffer_.GetBuffer()});
+    }
+}
+
+void UdpConnection::OnConnectionAccepted()
+{
+    if (state_ == UdpConnectionState::Connecting)
+        state_ = UdpConnectionState::Connected;
+}
+
+void UdpConnection::EnqueueMessage(PacketType channel, NetworkMessageId messageId, const unsigned char* data, unsigned numBytes)
+{
+    const unsigned short sequence = channels_[channel].nextOutgoingSequence_++;
+    const unsigned numFragments = ea::max(1u, (numBytes + MaxFragmentSize - 1) / MaxFragmentSize);
+    if (numFragments > maxFragments)
+    {
+        URHO3D_LOGERROR("{}: Message #{} is too big ({} bytes)", ToString(), static_cast<unsigned>(messageId), numBytes);
+        return;
+    }
+
+    for (unsigned fragmentIndex = 0; fragmentIndex < numFragments; ++fragmentIndex)
+    {
+        const unsigned offset = fragmentIndex * MaxFragmentSize;
+        const unsigned size = ea::min(MaxFragmentSize, numBytes - offset);
+
+        OutgoingMessage& message = outgoingMessages_.emplace_back();
+        message.channel_ = channel;
+        message.messageId_ = messageId;
+        message.sequence_ = sequence;
+        message.fragmentIndex_ = fragmentIndex;
+        message.numFragments_ = numFragments;
+        message.data_.assign(data + offset, data + offset + size);
+
+        if (IsReliable(channel))
+        {
+            message.reliableId_ = nextReliableId_++;
+            message.lastSendTime_ = GetLocalTime();
+            pendingReliable_[message.reliableId_] = message;
+        }
+    }
+}
+
+void UdpConnection::OnDatagramReceived(MemoryBuffer& src, ea::vector<ea::pair<NetworkMessageId, ByteVector>>& receivedMessages)
+{
+    if (src.GetSize() < datagramHeaderSize)
+        return;
+
+    const unsigned now = GetLocalTime();
+    const unsigned short sequence = src.ReadUShort();
+    const unsigned short ack = src.ReadUShort();
+    const unsigned ackBits = src.ReadUInt();
+
+    ProcessAcknowledgement(ack, ackBits);
+
+    // Update received sequences, ignore duplicate datagrams
+    if (!hasReceivedDatagram_)
+    {
+        hasReceivedDatagram_ = true;
+        latestReceivedSequence_ = sequence;
+        receivedSequenceBits_ = 0;
+    }
+    else if (IsSequenceNewer(sequence, latestReceivedSequence_))
+    {
+        const unsigned shift = static_cast<unsigned short>(sequence - latestReceivedSequence_);
+        if (shift > 32)
+            receivedSequenceBits_ = 0;
+        else if (shift == 32)
+            receivedSequenceBits_ = 1u << 31;
+        else
+            receivedSequenceBits_ = (receivedSequenceBits_ << shift) | (1u << (shift - 1));
+        latestReceivedSequence_ = sequence;
+    }
+    else
+    {
+        const unsigned distance = static_cast<unsigned short>(latestReceivedSequence_ - sequence);
+        if (distance == 0)
+            return;
+        if (distance <= 32)
+        {
+            const unsigned bit = 1u << (distance - 1);
+            if (receivedSequenceBits_ & bit)
+                return;
+            receivedSequenceBits_ |= bit;
+        }
+    }
+
+    // Datagrams without messages are not acknowledged explicitly to avoid endless ping-pong
+    if (!src.IsEof())
+        isAckPending_ = true;
+
+    while (!src.IsEof())
+    {
+        const unsigned char flags = src.ReadUByte();
+        const auto channel = static_cast<PacketType>(flags & channelMask);
+        const auto messageId = static_cast<NetworkMessageId>(src.ReadVLE());
+        const unsigned short messageSequence = src.ReadUShort();
+        unsigned fragmentIndex = 0;
+        unsigned numFragments = 1;
+        if (flags & fragmentedFlag)
+        {
+            fragmentIndex = src.ReadVLE();
+            numFragments = src.ReadVLE();
+        }
+        const unsigned size = src.ReadVLE();
+        if (src.GetPosition() + size > src.GetSize())
+        {
+            URHO3D_LOGWARNING("{}: Malformed datagram received", ToString());
+            return;
+        }
+
+        ByteVector data(size);
+        src.Read(data.data(), size);
+        ReceiveMessageFragment(channel, messageId, messageSequence, fragmentIndex, numFragments, ea::move(data), now,
+            receivedMessages);
+    }
+}
+
+void UdpConnection::ProcessAcknowledgement(unsigned short ack, unsigned ackBits)
+{
+    AcknowledgeDatagram(ack);
+    for (unsigned i = 0; i < 32; ++i)
+    {
+        if (ackBits & (1u << i))
+            AcknowledgeDatagram(static_cast<unsigned short>(ack - 1 - i));
+    }
+}
+
+void UdpConnection::AcknowledgeDatagram(unsigned short sequence)
+{
+    SentDatagram& datagram = sentDatagrams_[sequence % SentDatagramHistory];
+    if (datagram.sequence_ != sequence)
+        return;
+
+    for (unsigned reliableId : datagram.reliableIds_)
+        pendingReliable_.erase(reliableId);
+    datagram.sequence_ = ea::nullopt;
+    datagram.reliableIds_.clear();
+}
+
+bool UdpConnection::IsDuplicate(PacketType channel, unsigned short sequence) const
+{
+    const ChannelState& state = channels_[channel];
+    switch (channel)
+    {
+    case PT_UNRELIABLE_ORDERED:
+        return state.hasReceivedAny_ && !IsSequenceNewer(sequence, static_cast<unsigned short>(state.nextExpectedSequence_ - 1));
+
+    case PT_RELIABLE_ORDERED:
+        return IsSequenceNewer(state.nextExpectedSequence_, sequence) || state.bufferedMessages_.contains(sequence);
+
+    case PT_RELIABLE_UNORDERED:
+        return state.receivedSequences_[sequence % ReceivedSequenceHistory] == sequence;
+
+    case PT_UNRELIABLE_UNORDERED:
+    default:
+        return false;
+    }
+}
+
+void UdpConnection::ReceiveMessageFragment(PacketType channel, NetworkMessageId messageId, unsigned short sequence,
+    unsigned fragmentIndex, unsigned numFragments, ByteVector data, unsigned now,
+    ea::vector<ea::pair<NetworkMessageId, ByteVector>>& receivedMessages)
+{
+    if (IsDuplicate(channel, sequence))
+        return;
+
+    if (numFragments <= 1)
+    {
+        ReceiveMessage(channel, messageId, sequence, ea::move(data), receivedMessages);
+        return;
+    }
+
+    if (numFragments > maxFragments || fragmentIndex >= numFragments || data.empty())
+    {
+        URHO3D_LOGWARNING("{}: Malformed message fragment received", ToString());
+        return;
+    }
+
+    const auto key = ea::make_pair(static_cast<unsigned>(channel), sequence);
+    IncomingFragments& fragments = incomingFragments_[key];
+    if (fragments.fragments_.empty())
+    {
+        fragments.messageId_ = messageId;
+        fragments.numFragments_ = numFragments;
+        fragments.fragments_.resize(numFragments);
+    }
+    else if (fragments.numFragments_ != numFragments || fragments.messageId_ != messageId)
+    {
+        URHO3D_LOGWARNING("{}: Inconsistent message fragment received", ToString());
+        return;
+    }
+
+    fragments.lastReceiveTime_ = now;
+    if (!fragments.fragments_[fragmentIndex].empty())
+        return;
+
+    fragments.fragments_[fragmentIndex] = ea::move(data);
+    if (++fragments.numReceived_ < fragments.numFragments_)
+        return;
+
+    ByteVector message;
+    for (const ByteVector& fragment : fragments.fragments_)
+        message.insert(message.end(), fragment.begin(), fragment.end());
+    incomingFragments_.erase(key);
+
+    ReceiveMessage(channel, messageId, sequence, ea::move(message), receivedMessages);
+}
+
+void UdpConnection::ReceiveMessage(PacketType channel, NetworkMessageId messageId, unsigned short sequence,
+    ByteVector data, ea::vector<ea::pair<NetworkMessageId, ByteVector>>& receivedMessages)
+{
+    ChannelState& state = channels_[channel];
+    switch (channel)
+    {
+    case PT_UNRELIABLE_ORDERED:
+        state.hasReceivedAny_ = true;
+        state.nextExpectedSequence_ = sequence + 1;
+        receivedMessages.emplace_back(messageId, ea::move(data));
+        break;
+
+    case PT_RELIABLE_UNORDERED:
+        state.receivedSequences_[sequence % ReceivedSequenceHistory] = sequence;
+        receivedMessages.emplace_back(messageId, ea::move(data));
+        break;
+
+    case PT_RELIABLE_ORDERED:
+        if (sequence != state.nextExpectedSequence_)
+        {
+            state.bufferedMessages_.emplace(sequence, ea::make_pair(messageId, ea::move(data)));
+            break;
+        }
+
+        receivedMessages.emplace_back(messageId, ea::move(data));
+        ++state.nextExpectedSequence_;
+
+        // Deliver buffered messages that are now in order
+        while (true)
+        {
+            const auto iter = state.bufferedMessages_.find(state.nextExpectedSequence_);
+            if (iter == state.bufferedMessages_.end())
+                break;
+
+            receivedMessages.emplace_back(iter->second.first, ea::move(iter->second.second));
+            state.bufferedMessages_.erase(iter);
+            ++state.nextExpectedSequence_;
+        }
+        break;
+
+    case PT_UNRELIABLE_UNORDERED:
+    default:
+        receivedMessages.emplace_back(messageId, ea::move(data));
+        break;
+    }
+}
+
+unsigned UdpConnection::GetResendTimeout() const
+{
+    // Ping is half of round-trip time, leave some space for delayed acknowledgement
+    const unsigned ping = clock_->IsReady() ? clock_->GetPing() : 100;
+    return Clamp(ping * 3 + 50, 100u, 1000u);
+}
+
+void UdpConnection::Update(unsigned now, ea::vector<UdpDatagram>& outgoingDatagrams)
+{
+    if (state_ == UdpConnectionState::Disconnected)
+        return;
+
+    const unsigned timeoutMs = transport_ ? transport_->GetTimeout() : UdpTransport::DefaultTimeoutMs;
+    if (now - lastReceiveTime_ > timeoutMs)
+    {
+        URHO3D_LOGINFO("{}: Connection timed out", ToString());
+        state_ = UdpConnectionState::Disconnected;
+        return;
+    }
+
+    if (state_ == UdpConnectionState::Connecting)
+    {
+        if (lastHandshakeTime_ == 0 || now - lastHandshakeTime_ >= handshakeIntervalMs)
+        {
+            lastHandshakeTime_ = now;
+            datagramBuffer_.Clear();
+            WriteDatagramKind(datagramBuffer_, DatagramKind::Connect);
+            datagramBuffer_.WriteUInt(connectionMagic);
+            outgoingDatagrams.push_back(UdpDatagram{endpoint_, datagramBuffer_.GetBuffer()});
+        }
+        return;
+    }
+
+    // Discard incomplete messages that will never be completed
+    ea::erase_if(incomingFragments_,
+        [&](const auto& elem) { return now - elem.second.lastReceiveTime_ > fragmentTimeoutMs; });
+
+    // Send clock messages at the last time to have better precision
+    while (const auto clockMessage = clock_->PollMessage())
+    {
+        SendGeneratedMessage(MSG_CLOCK_SYNC, PT_UNRELIABLE_UNORDERED,
+            [&](VectorBuffer& msg, ea::string* debugInfo)
+        {
+            clockMessage->Save(msg);
+            return true;
+        });
+    }
+
+    // Resend reliable messages that were not acknowledged in time, keeping original order
+    const unsigned resendTimeout = GetResendTimeout();
+    ea::vector<unsigned> expiredIds;
+    for (const auto& [reliableId, message] : pendingReliable_)
+    {
+        if (now - message.lastSendTime_ >= resendTimeout)
+            expiredIds.push_back(reliableId);
+    }
+    ea::sort(expiredIds.begin(), expiredIds.end());
+    for (unsigned reliableId : expiredIds)
+    {
+        outgoingMessages_.push_back(pendingReliable_[reliableId]);
+        ++numMessagesResent_;
+    }
+
+    FlushDatagrams(now, outgoingDatagrams);
+}
+
+void UdpConnection::FlushDatagrams(unsigned now, ea::vector<UdpDatagram>& outgoingDatagrams)
+{
+    const bool needKeepAlive = now - lastSendTime_ >= keepAliveIntervalMs;
+    if (outgoingMessages_.empty() && !isAckPending_ && !needKeepAlive)
+        return;
+
+    BeginDatagram(datagramBuffer_);
+    unsigned numMessagesInDatagram = 0;
+    for (const OutgoingMessage& message : outgoingMessages_)
+    {
+        const unsigned messageSize = maxMessageHeaderSize + message.data_.size();
+        if (numMessagesInDatagram > 0 && datagramBuffer_.GetSize() + messageSize > MaxDatagramSize)
+        {
+            EndDatagram(datagramBuffer_, outgoingDatagrams);
+            BeginDatagram(datagramBuffer_);
+            numMessagesInDatagram = 0;
+        }
+
+        const bool isFragmented = message.numFragments_ > 1;
+        datagramBuffer_.WriteUByte(static_cast<unsigned char>(message.channel_) | (isFragmented ? fragmentedFlag : 0));
+        datagramBuffer_.WriteVLE(message.messageId_);
+        datagramBuffer_.WriteUShort(message.sequence_);
+        if (isFragmented)
+        {
+            datagramBuffer_.WriteVLE(message.fragmentIndex_);
+            datagramBuffer_.WriteVLE(message.numFragments_);
+        }
+        datagramBuffer_.WriteVLE(message.data_.size());
+        datagramBuffer_.Write(message.data_.data(), message.data_.size());
+        ++numMessagesInDatagram;
+
+        if (message.reliableId_ != 0)
+        {
+            currentDatagram_->reliableIds_.push_back(message.reliableId_);
+            const auto iter = pendingReliable_.find(message.reliableId_);
+            if (iter != pendingReliable_.end())
+                iter->second.lastSendTime_ = now;
+        }
+    }
+    EndDatagram(datagramBuffer_, outgoingDatagrams);
+
+    outgoingMessages_.clear();
+    isAckPending_ = false;
+    lastSendTime_ = now;
+}
+
+void UdpConnection::BeginDatagram(VectorBuffer& dest)
+{
+    const unsigned short sequence = nextDatagramSequence_++;
+    currentDatagram_ = &sentDatagrams_[sequence % SentDatagramHistory];
+    currentDatagram_->sequence_ = sequence;
+    currentDatagram_->reliableIds_.clear();
+
+    dest.Clear();
+    WriteDatagramKind(dest, DatagramKind::Data);
+    dest.WriteUShort(sequence);
+    dest.WriteUShort(latestReceivedSequence_);
+    dest.WriteUInt(hasReceivedDatagram_ ? receivedSequenceBits_ : 0);
+}
+
+void UdpConnection::EndDatagram(VectorBuffer& dest, ea::vector<UdpDatagram>& outgoingDatagrams)
+{
+    outgoingDatagrams.push_back(UdpDatagram{endpoint_, dest.GetBuffer()});
+    currentDatagram_ = nullptr;
+    ++numDatagramsSent_;
+}
+
+UdpTransport::UdpTransport(Context* context)
+    : Object(context)
+{
+#ifdef _WIN32
+    WSADATA data;
+    WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+}
+
+UdpTransport::~UdpTransport()
+{
+    Stop();
+#ifdef _WIN32
+    WSACleanup();
+#endif
+}
+
+bool UdpTransport::OpenSocket(unsigned short port)
+{
+    if (ioThread_)
+    {
+        URHO3D_LOGERROR("UDP transport is already open");
+        return false;
+    }
+
+    const SocketHandle socketHandle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (socketHandle == invalidSocket)
+    {
+        URHO3D_LOGERROR("Failed to create UDP socket");
+        return false;
+    }
+
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    ioctlsocket(socketHandle, FIONBIO, &nonBlocking);
+#else
+    fcntl(socketHandle, F_SETFL, fcntl(socketHandle, F_GETFL, 0) | O_NONBLOCK);
+#endif
+
+    // Larger buffers reduce losses when many datagrams are sent in one frame
+    const int bufferSize = 4 * 1024 * 1024;
+    setsockopt(socketHandle, SOL_SOCKET, SO_RCVBUF, reinterpret_cast<const char*>(&bufferSize), sizeof(bufferSize));
+    setsockopt(socketHandle, SOL_SOCKET, SO_SNDBUF, reinterpret_cast<const char*>(&bufferSize), sizeof(bufferSize));
+
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_ANY);
+    address.sin_port = htons(port);
+    if (bind(socketHandle, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+    {
+        URHO3D_LOGERROR("Failed to bind UDP socket to port {}", port);
+        CloseSocket(socketHandle);
+        return false;
+    }
+
+    socklen_t addressLength = sizeof(address);
+    getsockname(socketHandle, reinterpret_cast<sockaddr*>(&address), &addressLength);
+    localPort_ = ntohs(address.sin_port);
+
+    ioThread_ = ea::make_unique<UdpTransportThread>(socketHandle);
+    ioThread_->Run();
+    return true;
+}
+
+bool UdpTransport::Listen(unsigned short port)
+{
+    if (!OpenSocket(port))
+        return false;
+
+    isServer_ = true;
+    URHO3D_LOGINFO("UDP transport is listening on port {}", localPort_);
+    return true;
+}
+
+UdpConnection* UdpTransport::Connect(const ea::string& address, unsigned short port)
+{
+    const auto endpoint = UdpEndpoint::FromString(address, port);
+    if (!endpoint)
+    {
+        URHO3D_LOGERROR("Invalid address '{}'", address);
+        return nullptr;
+    }
+
+    if (!ioThread_ && !OpenSocket(0))
+        return nullptr;
+
+    auto connection = MakeShared<UdpConnection>(context_, this, *endpoint, true);
+    connections_[*endpoint] = connection;
+    return connection;
+}
+
+void UdpTransport::Stop()
+{
+    if (!ioThread_)
+        return;
+
+    for (const auto& [endpoint, connection] : connections_)
+        connection->Disconnect();
+    ioThread_->PushOutgoing(outgoingDatagrams_);
+
+    // Give I/O thread a chance to send disconnect notifications
+    const unsigned numConnections = connections_.size();
+    connections_.clear();
+    if (numConnections > 0)
+        Time::Sleep(ioWaitTimeoutMs * 2);
+
+    ioThread_ = nullptr;
+    isServer_ = false;
+    localPort_ = 0;
+}
+
+void UdpTransport::Update()
+{
+    if (!ioThread_)
+        return;
+
+    ioThread_->PopIncoming(incomingDatagrams_);
+    for (const UdpDatagram& datagram : incomingDatagrams_)
+        ProcessDatagram(datagram);
+    incomingDatagrams_.clear();
+
+    const unsigned now = Time::GetSystemTime();
+    ea::vector<SharedPtr<UdpConnection>> disconnectedConnections;
+    for (const auto& [endpoint, connection] : connections_)
+    {
+        connection->Update(now, outgoingDatagrams_);
+        if (connection->GetState() == UdpConnectionState::Disconnected)
+            disconnectedConnections.push_back(connection);
+    }
+    for (UdpConnection* connection : disconnectedConnections)
+        RemoveConnection(connection);
+
+    if (simulatedPacketLoss_ > 0.0f)
+        ea::erase_if(outgoingDatagrams_, [this](const UdpDatagram&) { return IsDatagramDropped(); });
+    ioThread_->PushOutgoing(outgoingDatagrams_);
+}
+
+void UdpTransport::ProcessDatagram(const UdpDatagram& datagram)
+{
+    if (datagram.data_.empty())
+        return;
+
+    MemoryBuffer src(datagram.data_);
+    const auto kind = static_cast<DatagramKind>(src.ReadUByte());
+
+    const auto iter = connections_.find(datagram.endpoint_);
+    SharedPtr<UdpConnection> connection = iter != connections_.end() ? iter->second : nullptr;
+    if (connection)
+        connection->lastReceiveTime_ = Time::GetSystemTime();
+
+    switch (kind)
+    {
+    case DatagramKind::Connect:
+    {
+        if (!isServer_ || src.ReadUInt() != connectionMagic)
+            break;
+
+        // Acknowledge every request in case previous response was lost
+        if (!connection)
+        {
+            connection = MakeShared<UdpConnection>(context_, this, datagram.endpoint_, false);
+            connections_[datagram.endpoint_] = connection;
+            URHO3D_LOGINFO("{}: Client connected", connection->ToString());
+            OnConnected(this, connection);
+        }
+
+        VectorBuffer response;
+        WriteDatagramKind(response, DatagramKind::Accept);
+        outgoingDatagrams_.push_back(UdpDatagram{datagram.endpoint_, response.GetBuffer()});
+        break;
+    }
+
+    case DatagramKind::Accept:
+        if (connection && connection->GetState() == UdpConnectionState::Connecting)
+        {
+            connection->OnConnectionAccepted();
+            URHO3D_LOGINFO("{}: Connected to server", connection->ToString());
+            OnConnected(this, connection);
+        }
+        break;
+
+    case DatagramKind::Data:
+        if (connection && connection->IsConnected())
+        {
+            receivedMessages_.clear();
+            connection->OnDatagramReceived(src, receivedMessages_);
+            for (auto& [messageId, data] : receivedMessages_)
+            {
+                MemoryBuffer messageData(data);
+                if (messageId == MSG_CLOCK_SYNC)
+                {
+                    ClockSynchronizerMessage clockMessage;
+                    clockMessage.Load(messageData);
+                    connection->clock_->ProcessMessage(clockMessage);
+                    continue;
+                }
+
+                connection->OnMessageReceived(messageId, messageData);
+                OnMessage(this, connection, messageId, messageData);
+            }
+        }
+        break;
+
+    case DatagramKind::Disconnect:
+        if (connection)
+        {
+            connection->state_ = UdpConnectionState::Disconnected;
+            RemoveConnection(connection);
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+void UdpTransport::RemoveConnection(UdpConnection* connection)
+{
+    SharedPtr<UdpConnection> connectionHolder{connection};
+    if (connections_.erase(connection->GetEndpoint()) == 0)
+        return;
+
+    URHO3D_LOGINFO("{}: Disconnected", connection->ToString());
+    OnDisconnected(this, connection);
+}
+
+bool UdpTransport::IsDatagramDropped()
+{
+    return simulatedPacketLoss_ > 0.0f && random_.GetFloat() < simulatedPacketLoss_;
+}
+
+}
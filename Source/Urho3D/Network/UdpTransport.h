@@ -0,0 +1,292 @@
+//
+// Copyright (c) 2017-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+/// \file
+
+#pragma once
+
+#include "../Container/ByteVector.h"
+#include "../Core/Signal.h"
+#include "../Math/RandomEngine.h"
+#include "../Network/AbstractConnection.h"
+
+#include <EASTL/map.h>
+#include <EASTL/unique_ptr.h>
+#include <EASTL/unordered_map.h>
+
+namespace Urho3D
+{
+
+class ClockSynchronizer;
+class UdpTransport;
+class UdpTransportThread;
+
+/// IPv4 address and port of UDP peer. Address and port are stored in host byte order.
+struct UdpEndpoint
+{
+    unsigned address_{};
+    unsigned short port_{};
+
+    /// Parse address from string. Only numeric IPv4 addresses and "localhost" are supported.
+    static ea::optional<UdpEndpoint> FromString(const ea::string& address, unsigned short port);
+    /// Return address as string.
+    ea::string ToString() const;
+
+    bool operator==(const UdpEndpoint& rhs) const { return address_ == rhs.address_ && port_ == rhs.port_; }
+    bool operator!=(const UdpEndpoint& rhs) const { return !(*this == rhs); }
+    unsigned ToHash() const { return address_ * 31 + port_; }
+};
+
+/// Single UDP datagram exchanged between main thread and I/O thread.
+struct UdpDatagram
+{
+    UdpEndpoint endpoint_;
+    ByteVector data_;
+};
+
+/// Connection state of UdpConnection.
+enum class UdpConnectionState
+{
+    Connecting,
+    Connected,
+    Disconnected
+};
+
+/// Lightweight connection over UdpTransport.
+/// Outgoing messages are coalesced into datagrams of limited size when transport is updated.
+/// Reliable messages are resent until acknowledged, ordered channels drop or reorder messages as needed.
+/// Messages bigger than single datagram are split into fragments.
+class URHO3D_API UdpConnection : public AbstractConnection
+{
+    URHO3D_OBJECT(UdpConnection, AbstractConnection);
+
+public:
+    /// Max size of datagram payload, chosen to fit into common MTU.
+    static constexpr unsigned MaxDatagramSize = 1200;
+    /// Max size of message fragment, leaves space for datagram and message headers.
+    static constexpr unsigned MaxFragmentSize = MaxDatagramSize - 64;
+    /// Number of sent datagrams remembered for acknowledgement.
+    static constexpr unsigned SentDatagramHistory = 1024;
+    /// Number of sequence numbers remembered on receiver side for duplicate detection.
+    static constexpr unsigned ReceivedSequenceHistory = 1024;
+
+    UdpConnection(Context* context, UdpTransport* transport, const UdpEndpoint& endpoint, bool isClient);
+    ~UdpConnection() override;
+
+    /// Implement AbstractConnection
+    /// @{
+    void SendMessageInternal(NetworkMessageId messageId, bool reliable, bool inOrder, const unsigned char* data, unsigned numBytes) override;
+    ea::string ToString() const override;
+    bool IsClockSynchronized() const override;
+    unsigned RemoteToLocalTime(unsigned time) const override;
+    unsigned LocalToRemoteTime(unsigned time) const override;
+    unsigned GetLocalTime() const override;
+    unsigned GetLocalTimeOfLatestRoundtrip() const override;
+    unsigned GetPing() const override;
+    /// @}
+
+    /// Close connection and notify the other side.
+    void Disconnect();
+
+    /// Return remote endpoint.
+    const UdpEndpoint& GetEndpoint() const { return endpoint_; }
+    /// Return connection state.
+    UdpConnectionState GetState() const { return state_; }
+    /// Return whether the connection is established.
+    bool IsConnected() const { return state_ == UdpConnectionState::Connected; }
+    /// Return whether this is client side of connection.
+    bool IsClient() const { return isClient_; }
+    /// Return number of reliable messages waiting for acknowledgement.
+    unsigned GetNumPendingReliableMessages() const { return pendingReliable_.size(); }
+    /// Return total number of datagrams sent.
+    unsigned GetNumDatagramsSent() const { return numDatagramsSent_; }
+    /// Return total number of messages resent.
+    unsigned GetNumMessagesResent() const { return numMessagesResent_; }
+
+private:
+    friend class UdpTransport;
+
+    /// Message or message fragment queued for sending.
+    struct OutgoingMessage
+    {
+        PacketType channel_{};
+        NetworkMessageId messageId_{};
+        unsigned short sequence_{};
+        unsigned fragmentIndex_{};
+        unsigned numFragments_{};
+        ByteVector data_;
+
+        /// Reliable messages only: unique id for acknowledgement and time of the latest send.
+        unsigned reliableId_{};
+        unsigned lastSendTime_{};
+    };
+
+    /// Message being reassembled from fragments.
+    struct IncomingFragments
+    {
+        NetworkMessageId messageId_{};
+        unsigned numFragments_{};
+        unsigned numReceived_{};
+        unsigned lastReceiveTime_{};
+        ea::vector<ByteVector> fragments_;
+    };
+
+    /// Datagram that was sent and may be acknowledged.
+    struct SentDatagram
+    {
+        ea::optional<unsigned short> sequence_;
+        ea::vector<unsigned> reliableIds_;
+    };
+
+    /// Per-channel receiver state.
+    struct ChannelState
+    {
+        unsigned short nextOutgoingSequence_{};
+        /// Ordered channels only.
+        unsigned short nextExpectedSequence_{};
+        bool hasReceivedAny_{};
+        /// Reliable unordered channel only.
+        ea::vector<ea::optional<unsigned short>> receivedSequences_;
+        /// Reliable ordered channel only.
+        ea::map<unsigned short, ea::pair<NetworkMessageId, ByteVector>> bufferedMessages_;
+    };
+
+    /// Internal events processed by transport.
+    /// @{
+    void OnConnectionAccepted();
+    void OnDatagramReceived(MemoryBuffer& src, ea::vector<ea::pair<NetworkMessageId, ByteVector>>& receivedMessages);
+    void Update(unsigned now, ea::vector<UdpDatagram>& outgoingDatagrams);
+    /// @}
+
+    void EnqueueMessage(PacketType channel, NetworkMessageId messageId, const unsigned char* data, unsigned numBytes);
+    void ProcessAcknowledgement(unsigned short ack, unsigned ackBits);
+    void AcknowledgeDatagram(unsigned short sequence);
+    void ReceiveMessageFragment(PacketType channel, NetworkMessageId messageId, unsigned short sequence,
+        unsigned fragmentIndex, unsigned numFragments, ByteVector data, unsigned now,
+        ea::vector<ea::pair<NetworkMessageId, ByteVector>>& receivedMessages);
+    void ReceiveMessage(PacketType channel, NetworkMessageId messageId, unsigned short sequence, ByteVector data,
+        ea::vector<ea::pair<NetworkMessageId, ByteVector>>& receivedMessages);
+    bool IsDuplicate(PacketType channel, unsigned short sequence) const;
+    void FlushDatagrams(unsigned now, ea::vector<UdpDatagram>& outgoingDatagrams);
+    void BeginDatagram(VectorBuffer& dest);
+    void EndDatagram(VectorBuffer& dest, ea::vector<UdpDatagram>& outgoingDatagrams);
+    unsigned GetResendTimeout() const;
+
+    WeakPtr<UdpTransport> transport_;
+    const UdpEndpoint endpoint_;
+    const bool isClient_{};
+    UdpConnectionState state_{};
+    ea::unique_ptr<ClockSynchronizer> clock_;
+
+    unsigned lastReceiveTime_{};
+    unsigned lastSendTime_{};
+    unsigned lastHandshakeTime_{};
+
+    /// Outgoing state.
+    ea::vector<OutgoingMessage> outgoingMessages_;
+    ea::unordered_map<unsigned, OutgoingMessage> pendingReliable_;
+    unsigned nextReliableId_{1};
+    unsigned short nextDatagramSequence_{};
+    ea::vector<SentDatagram> sentDatagrams_;
+    SentDatagram* currentDatagram_{};
+
+    /// Incoming state.
+    ChannelState channels_[4];
+    ea::unordered_map<ea::pair<unsigned, unsigned short>, IncomingFragments> incomingFragments_;
+    bool hasReceivedDatagram_{};
+    unsigned short latestReceivedSequence_{};
+    unsigned receivedSequenceBits_{};
+    bool isAckPending_{};
+
+    /// Statistics.
+    unsigned numDatagramsSent_{};
+    unsigned numMessagesResent_{};
+
+    VectorBuffer datagramBuffer_;
+};
+
+/// Lightweight UDP transport that can be used as alternative to SLikeNet-based Network for dedicated servers.
+/// Socket I/O is performed on dedicated thread in batches, connections are processed on the main thread in Update.
+/// Only IPv4 is supported.
+class URHO3D_API UdpTransport : public Object
+{
+    URHO3D_OBJECT(UdpTransport, Object);
+
+public:
+    /// Connection is silently closed if nothing was received within this time.
+    static constexpr unsigned DefaultTimeoutMs = 10000;
+
+    Signal<void(UdpConnection* connection)> OnConnected;
+    Signal<void(UdpConnection* connection)> OnDisconnected;
+    Signal<void(UdpConnection* connection, NetworkMessageId messageId, MemoryBuffer& messageData)> OnMessage;
+
+    explicit UdpTransport(Context* context);
+    ~UdpTransport() override;
+
+    /// Open socket and accept incoming connections on given port. Use port 0 to pick any free port.
+    bool Listen(unsigned short port);
+    /// Open socket and start connecting to the server. Connection is usable after OnConnected is invoked.
+    UdpConnection* Connect(const ea::string& address, unsigned short port);
+    /// Close all connections and the socket.
+    void Stop();
+
+    /// Process received datagrams and send queued messages. Should be called every frame.
+    void Update();
+
+    /// Set connection timeout in milliseconds.
+    void SetTimeout(unsigned timeoutMs) { timeoutMs_ = timeoutMs; }
+    /// Set probability of dropping each outgoing datagram. Used for testing.
+    void SetSimulatedPacketLoss(float packetLoss) { simulatedPacketLoss_ = packetLoss; }
+
+    /// Return whether the socket is open.
+    bool IsOpen() const { return ioThread_ != nullptr; }
+    /// Return local port of the socket.
+    unsigned short GetLocalPort() const { return localPort_; }
+    /// Return connection timeout in milliseconds.
+    unsigned GetTimeout() const { return timeoutMs_; }
+    /// Return all connections.
+    const auto& GetConnections() const { return connections_; }
+
+private:
+    friend class UdpConnection;
+
+    bool OpenSocket(unsigned short port);
+    void ProcessDatagram(const UdpDatagram& datagram);
+    void RemoveConnection(UdpConnection* connection);
+    bool IsDatagramDropped();
+
+    ea::unique_ptr<UdpTransportThread> ioThread_;
+    unsigned short localPort_{};
+    bool isServer_{};
+    unsigned timeoutMs_{DefaultTimeoutMs};
+
+    float simulatedPacketLoss_{};
+    RandomEngine random_;
+
+    ea::unordered_map<UdpEndpoint, SharedPtr<UdpConnection>> connections_;
+
+    ea::vector<UdpDatagram> incomingDatagrams_;
+    ea::vector<UdpDatagram> outgoingDatagrams_;
+    ea::vector<ea::pair<NetworkMessageId, ByteVector>> receivedMessages_;
+};
+
+}
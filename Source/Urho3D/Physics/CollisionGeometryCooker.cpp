@@ -0,0 +1,108 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Physics/CollisionGeometryCooker.h"
+
+#include "../Core/Context.h"
+#include "../Graphics/Model.h"
+#include "../IO/FileSystem.h"
+#include "../IO/Log.h"
+#include "../Physics/CookedCollisionGeometry.h"
+#include "../Resource/ResourceCache.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+CollisionGeometryCooker::CollisionGeometryCooker(Context* context)
+    : AssetTransformer(context)
+{
+}
+
+CollisionGeometryCooker::~CollisionGeometryCooker()
+{
+}
+
+void CollisionGeometryCooker::RegisterObject(Context* context)
+{
+    context->RegisterFactory<CollisionGeometryCooker>(Category_Transformer);
+
+    URHO3D_ATTRIBUTE("Triangle Mesh", bool, triangleMesh_, true, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Convex Hull", bool, convexHull_, true, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("GImpact Mesh", bool, gimpactMesh_, false, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("LOD Levels", unsigned, numLodLevels_, 1, AM_DEFAULT);
+}
+
+bool CollisionGeometryCooker::IsApplicable(const AssetTransformerInput& input)
+{
+    return input.inputFileName_.ends_with(".mdl", false);
+}
+
+bool CollisionGeometryCooker::Execute(
+    const AssetTransformerInput& input, AssetTransformerOutput& output, const AssetTransformerVector& transformers)
+{
+    auto cache = GetSubsystem<ResourceCache>();
+    auto model = cache->GetResource<Model>(input.resourceName_);
+    if (!model)
+        return false;
+
+    unsigned maxLodLevels = 0;
+    for (unsigned i = 0; i < model->GetNumGeometries(); ++i)
+        maxLodLevels = ea::max(maxLodLevels, model->GetNumGeometryLodLevels(i));
+
+    ea::vector<ShapeType> shapeTypes;
+    if (triangleMesh_)
+        shapeTypes.push_back(SHAPE_TRIANGLEMESH);
+    if (convexHull_)
+        shapeTypes.push_back(SHAPE_CONVEXHULL);
+    if (gimpactMesh_)
+        shapeTypes.push_back(SHAPE_GIMPACTMESH);
+
+    auto cookedGeometry = MakeShared<CookedCollisionGeometry>(context_);
+    for (unsigned lodLevel = 0; lodLevel < ea::min(numLodLevels_, maxLodLevels); ++lodLevel)
+    {
+        for (ShapeType shapeType : shapeTypes)
+        {
+            if (!cookedGeometry->CookGeometry(shapeType, model, lodLevel))
+                return false;
+        }
+    }
+
+    if (cookedGeometry->GetNumGeometries() == 0)
+        return true;
+
+    const ea::string fileName = input.tempPath_ + CookedCollisionGeometry::GetResourceName(input.resourceName_);
+    GetSubsystem<FileSystem>()->CreateDirsRecursive(GetPath(fileName));
+    if (!cookedGeometry->SaveFile(fileName))
+    {
+        URHO3D_LOGERROR("Failed to save cooked collision geometry to '{}'", fileName);
+        return false;
+    }
+
+    return true;
+}
+
+}
@@ -34,6 +34,7 @@
 #include "../Graphics/VertexBuffer.h"
 #include "../IO/Log.h"
 #include "../Physics/CollisionShape.h"
+#include "../Physics/CookedCollisionGeometry.h"
 #include "../Physics/PhysicsUtils.h"
 #include "../Physics/PhysicsWorld.h"
 #include "../Physics/RigidBody.h"
@@ -186,6 +187,34 @@ public:
         useQuantize_ = totalTriangles <= QUANTIZE_MAX_TRIANGLES;
     }
 
+    TriangleMeshInterface(const ea::vector<Vector3>& vertices, const ea::vector<unsigned>& indices) :
+        btTriangleIndexVertexArray()
+    {
+        if (!vertices.empty() && !indices.empty())
+        {
+            ea::shared_array<unsigned char> vertexData(new unsigned char[vertices.size() * sizeof(Vector3)]);
+            ea::shared_array<unsigned char> indexData(new unsigned char[indices.size() * sizeof(unsigned)]);
+            dataArrays_.push_back(vertexData);
+            dataArrays_.push_back(indexData);
+
+            memcpy(vertexData.get(), vertices.data(), vertices.size() * sizeof(Vector3));
+            memcpy(indexData.get(), indices.data(), indices.size() * sizeof(unsigned));
+
+            btIndexedMesh meshIndex;
+            meshIndex.m_numTriangles = indices.size() / 3;
+            meshIndex.m_triangleIndexBase = indexData.get();
+            meshIndex.m_triangleIndexStride = 3 * sizeof(unsigned);
+            meshIndex.m_numVertices = vertices.size();
+            meshIndex.m_vertexBase = vertexData.get();
+            meshIndex.m_vertexStride = sizeof(Vector3);
+            meshIndex.m_indexType = PHY_INTEGER;
+            meshIndex.m_vertexType = PHY_FLOAT;
+            m_indexedMeshes.push_back(meshIndex);
+        }
+
+        useQuantize_ = indices.size() / 3 <= QUANTIZE_MAX_TRIANGLES;
+    }
+
     /// OK to use quantization flag.
     bool useQuantize_;
 
@@ -212,8 +241,79 @@ TriangleMeshData::TriangleMeshData(CustomGeometry* custom)
     btGenerateInternalEdgeInfo(shape_.get(), infoMap_.get());
 }
 
+TriangleMeshData::TriangleMeshData(const CookedCollisionGeometryData& cooked)
+{
+    meshInterface_ = ea::make_unique<TriangleMeshInterface>(cooked.vertices_, cooked.indices_);
+
+    // Quantized BVH is loaded in place from the aligned copy of cooked buffer
+    btOptimizedBvh* bvh = nullptr;
+    if (!cooked.bvhData_.empty() && cooked.useQuantize_ == meshInterface_->useQuantize_)
+    {
+        bvhBuffer_ = btAlignedAlloc(cooked.bvhData_.size(), 16);
+        memcpy(bvhBuffer_, cooked.bvhData_.data(), cooked.bvhData_.size());
+        bvh = btOptimizedBvh::deSerializeInPlace(bvhBuffer_, cooked.bvhData_.size(), false);
+        if (!bvh)
+            URHO3D_LOGWARNING("Cooked triangle mesh BVH is incompatible and will be rebuilt");
+    }
+
+    shape_ = ea::make_unique<btBvhTriangleMeshShape>(meshInterface_.get(), meshInterface_->useQuantize_, !bvh);
+    if (bvh)
+        shape_->setOptimizedBvh(bvh);
+
+    infoMap_ = ea::make_unique<btTriangleInfoMap>();
+    if (bvh && cooked.triangleInfoKeys_.size() == cooked.triangleInfos_.size())
+    {
+        for (unsigned i = 0; i < cooked.triangleInfoKeys_.size(); ++i)
+        {
+            const CookedTriangleInfo& cookedInfo = cooked.triangleInfos_[i];
+            btTriangleInfo info;
+            info.m_flags = cookedInfo.flags_;
+            info.m_edgeV0V1Angle = cookedInfo.edgeAngles_.x_;
+            info.m_edgeV1V2Angle = cookedInfo.edgeAngles_.y_;
+            info.m_edgeV2V0Angle = cookedInfo.edgeAngles_.z_;
+            infoMap_->insert(cooked.triangleInfoKeys_[i], info);
+        }
+    }
+    else
+        btGenerateInternalEdgeInfo(shape_.get(), infoMap_.get());
+}
+
 TriangleMeshData::~TriangleMeshData()
 {
+    // Shape may reference BVH stored in the buffer
+    shape_.reset();
+    if (bvhBuffer_)
+        btAlignedFree(bvhBuffer_);
+}
+
+void TriangleMeshData::SaveCooked(CookedCollisionGeometryData& cooked) const
+{
+    const btOptimizedBvh* bvh = shape_->getOptimizedBvh();
+    cooked.useQuantize_ = meshInterface_->useQuantize_;
+    cooked.bvhData_.clear();
+    if (bvh)
+    {
+        // Serialize into aligned buffer first, Bullet expects it
+        const unsigned bufferSize = bvh->calculateSerializeBufferSize();
+        void* buffer = btAlignedAlloc(bufferSize, 16);
+        if (bvh->serialize(buffer, bufferSize, false))
+        {
+            const auto bytes = static_cast<const unsigned char*>(buffer);
+            cooked.bvhData_.assign(bytes, bytes + bufferSize);
+        }
+        btAlignedFree(buffer);
+    }
+
+    const int numTriangleInfos = infoMap_->size();
+    cooked.triangleInfoKeys_.resize(numTriangleInfos);
+    cooked.triangleInfos_.resize(numTriangleInfos);
+    for (int i = 0; i < numTriangleInfos; ++i)
+    {
+        const btTriangleInfo& info = *infoMap_->getAtIndex(i);
+        cooked.triangleInfoKeys_[i] = infoMap_->getKeyAtIndex(i).getUid1();
+        cooked.triangleInfos_[i].flags_ = info.m_flags;
+        cooked.triangleInfos_[i].edgeAngles_ = {info.m_edgeV0V1Angle, info.m_edgeV1V2Angle, info.m_edgeV2V0Angle};
+    }
 }
 
 GImpactMeshData::GImpactMeshData(Model* model, unsigned lodLevel)
@@ -226,6 +326,11 @@ GImpactMeshData::GImpactMeshData(CustomGeometry* custom)
     meshInterface_ = ea::make_unique<TriangleMeshInterface>(custom);
 }
 
+GImpactMeshData::GImpactMeshData(const CookedCollisionGeometryData& cooked)
+{
+    meshInterface_ = ea::make_unique<TriangleMeshInterface>(cooked.vertices_, cooked.indices_);
+}
+
 GImpactMeshData::~GImpactMeshData()
 {
 }
@@ -285,6 +390,18 @@ ConvexData::ConvexData(CustomGeometry* custom)
     BuildHull(vertices);
 }
 
+ConvexData::ConvexData(const CookedCollisionGeometryData& cooked)
+{
+    // Cooked data already contains the hull
+    vertexCount_ = cooked.vertices_.size();
+    vertexData_ = new Vector3[vertexCount_];
+    ea::copy(cooked.vertices_.begin(), cooked.vertices_.end(), vertexData_.get());
+
+    indexCount_ = cooked.indices_.size();
+    indexData_ = new unsigned[indexCount_];
+    ea::copy(cooked.indices_.begin(), cooked.indices_.end(), indexData_.get());
+}
+
 void ConvexData::BuildHull(const ea::vector<Vector3>& vertices)
 {
     if (vertices.size())
@@ -415,6 +532,20 @@ CollisionGeometryData* CreateCollisionGeometryData(ShapeType shapeType, Model* m
     }
 }
 
+CollisionGeometryData* GetCookedCollisionGeometryData(ShapeType shapeType, Model* model, unsigned lodLevel)
+{
+    const ea::string& modelName = model->GetName();
+    if (modelName.empty())
+        return nullptr;
+
+    auto cache = model->GetSubsystem<ResourceCache>();
+    const ea::string cookedName = CookedCollisionGeometry::GetResourceName(modelName);
+    auto cookedGeometry = cache->GetExistingResource<CookedCollisionGeometry>(cookedName);
+    if (!cookedGeometry && cache->Exists(cookedName))
+        cookedGeometry = cache->GetResource<CookedCollisionGeometry>(cookedName);
+    return cookedGeometry ? cookedGeometry->GetGeometryData(shapeType, lodLevel) : nullptr;
+}
+
 CollisionGeometryData* CreateCollisionGeometryData(ShapeType shapeType, CustomGeometry* custom)
 {
     switch (shapeType)
@@ -1109,13 +1240,20 @@ void CollisionShape::UpdateCachedGeometryShape(CollisionGeometryDataCache& cache
         auto cachedGeometry = cache.find(id);
         if (cachedGeometry != cache.end())
             geometry_ = cachedGeometry->second;
+        else if (!HasDynamicBuffers(model_, lodLevel_))
+        {
+            // Prefer geometry cooked by asset pipeline, it's shared between all physics worlds
+            geometry_ = GetCookedCollisionGeometryData(shapeType_, model_, lodLevel_);
+            if (!geometry_)
+                geometry_ = CreateCollisionGeometryData(shapeType_, model_, lodLevel_);
+            assert(geometry_);
+            cache[id] = geometry_;
+        }
         else
         {
+            // Do not cache geometry of model with dynamic buffers
             geometry_ = CreateCollisionGeometryData(shapeType_, model_, lodLevel_);
             assert(geometry_);
-            // Check if model has dynamic buffers, do not cache in that case
-            if (!HasDynamicBuffers(model_, lodLevel_))
-                cache[id] = geometry_;
         }
 
         shape_.reset(CreateCollisionGeometryDataShape(shapeType_, geometry_, cachedWorldScale_ * size_));
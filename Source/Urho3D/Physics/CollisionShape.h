@@ -49,6 +49,8 @@ class RigidBody;
 class Terrain;
 class TriangleMeshInterface;
 
+struct CookedCollisionGeometryData;
+
 /// Collision shape type.
 enum ShapeType
 {
@@ -80,14 +82,21 @@ struct TriangleMeshData : public CollisionGeometryData
     TriangleMeshData(Model* model, unsigned lodLevel);
     /// Construct from a custom geometry.
     explicit TriangleMeshData(CustomGeometry* custom);
+    /// Construct from cooked data. BVH and triangle info are built only if not cooked.
+    explicit TriangleMeshData(const CookedCollisionGeometryData& cooked);
     ~TriangleMeshData();
 
+    /// Store BVH and triangle info map into cooked data.
+    void SaveCooked(CookedCollisionGeometryData& cooked) const;
+
     /// Bullet triangle mesh interface.
     ea::unique_ptr<TriangleMeshInterface> meshInterface_;
     /// Bullet triangle mesh collision shape.
     ea::unique_ptr<btBvhTriangleMeshShape> shape_;
     /// Bullet triangle info map.
     ea::unique_ptr<btTriangleInfoMap> infoMap_;
+    /// Aligned buffer that contains BVH loaded from cooked data.
+    void* bvhBuffer_{};
 };
 
 /// Triangle mesh geometry data.
@@ -97,6 +106,8 @@ struct GImpactMeshData : public CollisionGeometryData
     GImpactMeshData(Model* model, unsigned lodLevel);
     /// Construct from a custom geometry.
     explicit GImpactMeshData(CustomGeometry* custom);
+    /// Construct from cooked data.
+    explicit GImpactMeshData(const CookedCollisionGeometryData& cooked);
     ~GImpactMeshData();
 
     /// Bullet triangle mesh interface.
@@ -110,6 +121,8 @@ struct ConvexData : public CollisionGeometryData
     ConvexData(Model* model, unsigned lodLevel);
     /// Construct from a custom geometry.
     explicit ConvexData(CustomGeometry* custom);
+    /// Construct from cooked data.
+    explicit ConvexData(const CookedCollisionGeometryData& cooked);
 
     /// Build the convex hull from vertices.
     void BuildHull(const ea::vector<Vector3>& vertices);
@@ -0,0 +1,292 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Physics/CookedCollisionGeometry.h"
+
+#include "../Core/Context.h"
+#include "../Graphics/Geometry.h"
+#include "../Graphics/Model.h"
+#include "../Graphics/VertexBuffer.h"
+#include "../IO/Deserializer.h"
+#include "../IO/FileSystem.h"
+#include "../IO/Log.h"
+#include "../IO/Serializer.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+const unsigned cookedGeometryVersion = 1;
+
+/// Extract indexed triangles from the model LOD as single mesh.
+void ExtractTriangles(Model* model, unsigned lodLevel, ea::vector<Vector3>& vertices, ea::vector<unsigned>& indices)
+{
+    const unsigned numGeometries = model->GetNumGeometries();
+    for (unsigned i = 0; i < numGeometries; ++i)
+    {
+        Geometry* geometry = model->GetGeometry(i, lodLevel);
+        if (!geometry)
+        {
+            URHO3D_LOGWARNING("Skipping null geometry for collision geometry cooking");
+            continue;
+        }
+
+        const unsigned char* vertexData;
+        const unsigned char* indexData;
+        unsigned vertexSize;
+        unsigned indexSize;
+        const ea::vector<VertexElement>* elements;
+
+        geometry->GetRawData(vertexData, vertexSize, indexData, indexSize, elements);
+        if (!vertexData || !indexData || !elements || VertexBuffer::GetElementOffset(*elements, TYPE_VECTOR3, SEM_POSITION) != 0)
+        {
+            URHO3D_LOGWARNING("Skipping geometry with no or unsuitable CPU-side geometry data for collision geometry cooking");
+            continue;
+        }
+
+        const unsigned indexStart = geometry->GetIndexStart();
+        const unsigned indexCount = geometry->GetIndexCount() / 3 * 3;
+        const auto readIndex = [&](unsigned index)
+        {
+            const unsigned char* data = &indexData[(indexStart + index) * indexSize];
+            return indexSize == sizeof(unsigned short)
+                ? static_cast<unsigned>(*reinterpret_cast<const unsigned short*>(data))
+                : *reinterpret_cast<const unsigned*>(data);
+        };
+
+        if (indexCount == 0)
+            continue;
+
+        // Copy only referenced range of vertices
+        unsigned minVertex = M_MAX_UNSIGNED;
+        unsigned maxVertex = 0;
+        for (unsigned j = 0; j < indexCount; ++j)
+        {
+            const unsigned index = readIndex(j);
+            minVertex = Min(minVertex, index);
+            maxVertex = Max(maxVertex, index);
+        }
+
+        const unsigned baseVertex = vertices.size();
+        for (unsigned j = minVertex; j <= maxVertex; ++j)
+            vertices.push_back(*reinterpret_cast<const Vector3*>(&vertexData[j * vertexSize]));
+
+        for (unsigned j = 0; j < indexCount; ++j)
+            indices.push_back(readIndex(j) - minVertex + baseVertex);
+    }
+}
+
+}
+
+CookedCollisionGeometry::CookedCollisionGeometry(Context* context)
+    : Resource(context)
+{
+}
+
+CookedCollisionGeometry::~CookedCollisionGeometry() = default;
+
+void CookedCollisionGeometry::RegisterObject(Context* context)
+{
+    context->AddFactoryReflection<CookedCollisionGeometry>();
+}
+
+bool CookedCollisionGeometry::BeginLoad(Deserializer& source)
+{
+    geometries_.clear();
+
+    if (source.ReadFileID() != "UCOL")
+    {
+        URHO3D_LOGERROR("{} is not a valid cooked collision geometry file", source.GetName());
+        return false;
+    }
+
+    const unsigned version = source.ReadUInt();
+    if (version != cookedGeometryVersion)
+    {
+        URHO3D_LOGERROR("{} has unsupported cooked collision geometry version {}", source.GetName(), version);
+        return false;
+    }
+
+    const unsigned numGeometries = source.ReadVLE();
+    geometries_.resize(numGeometries);
+    for (Entry& entry : geometries_)
+    {
+        CookedCollisionGeometryData& cooked = entry.cooked_;
+        cooked.shapeType_ = static_cast<ShapeType>(source.ReadUInt());
+        cooked.lodLevel_ = source.ReadUInt();
+
+        cooked.vertices_.resize(source.ReadVLE());
+        source.Read(cooked.vertices_.data(), cooked.vertices_.size() * sizeof(Vector3));
+        cooked.indices_.resize(source.ReadVLE());
+        source.Read(cooked.indices_.data(), cooked.indices_.size() * sizeof(unsigned));
+
+        cooked.useQuantize_ = source.ReadBool();
+        source.ReadBuffer(cooked.bvhData_);
+
+        cooked.triangleInfoKeys_.resize(source.ReadVLE());
+        source.Read(cooked.triangleInfoKeys_.data(), cooked.triangleInfoKeys_.size() * sizeof(int));
+        cooked.triangleInfos_.resize(cooked.triangleInfoKeys_.size());
+        for (CookedTriangleInfo& info : cooked.triangleInfos_)
+        {
+            info.flags_ = source.ReadInt();
+            info.edgeAngles_ = source.ReadVector3();
+        }
+    }
+
+    SetMemoryUse(source.GetSize());
+    return true;
+}
+
+bool CookedCollisionGeometry::Save(Serializer& dest) const
+{
+    dest.WriteFileID("UCOL");
+    dest.WriteUInt(cookedGeometryVersion);
+
+    dest.WriteVLE(geometries_.size());
+    for (const Entry& entry : geometries_)
+    {
+        const CookedCollisionGeometryData& cooked = entry.cooked_;
+        dest.WriteUInt(cooked.shapeType_);
+        dest.WriteUInt(cooked.lodLevel_);
+
+        dest.WriteVLE(cooked.vertices_.size());
+        dest.Write(cooked.vertices_.data(), cooked.vertices_.size() * sizeof(Vector3));
+        dest.WriteVLE(cooked.indices_.size());
+        dest.Write(cooked.indices_.data(), cooked.indices_.size() * sizeof(unsigned));
+
+        dest.WriteBool(cooked.useQuantize_);
+        dest.WriteBuffer(cooked.bvhData_);
+
+        dest.WriteVLE(cooked.triangleInfoKeys_.size());
+        dest.Write(cooked.triangleInfoKeys_.data(), cooked.triangleInfoKeys_.size() * sizeof(int));
+        for (const CookedTriangleInfo& info : cooked.triangleInfos_)
+        {
+            dest.WriteInt(info.flags_);
+            dest.WriteVector3(info.edgeAngles_);
+        }
+    }
+
+    return true;
+}
+
+bool CookedCollisionGeometry::CookGeometry(ShapeType shapeType, Model* model, unsigned lodLevel)
+{
+    if (!model)
+    {
+        URHO3D_LOGERROR("Null model, can not cook collision geometry");
+        return false;
+    }
+
+    CookedCollisionGeometryData cooked;
+    cooked.shapeType_ = shapeType;
+    cooked.lodLevel_ = lodLevel;
+
+    switch (shapeType)
+    {
+    case SHAPE_TRIANGLEMESH:
+    {
+        ExtractTriangles(model, lodLevel, cooked.vertices_, cooked.indices_);
+        const TriangleMeshData data{cooked};
+        data.SaveCooked(cooked);
+        break;
+    }
+
+    case SHAPE_CONVEXHULL:
+    {
+        const ConvexData data{model, lodLevel};
+        cooked.vertices_.assign(data.vertexData_.get(), data.vertexData_.get() + data.vertexCount_);
+        cooked.indices_.assign(data.indexData_.get(), data.indexData_.get() + data.indexCount_);
+        break;
+    }
+
+    case SHAPE_GIMPACTMESH:
+        // GImpact tree depends on shape scale and is built by the shape itself
+        ExtractTriangles(model, lodLevel, cooked.vertices_, cooked.indices_);
+        break;
+
+    default:
+        URHO3D_LOGERROR("Collision geometry of shape type {} can not be cooked", static_cast<unsigned>(shapeType));
+        return false;
+    }
+
+    if (Entry* entry = FindEntry(shapeType, lodLevel))
+        *entry = Entry{ea::move(cooked), nullptr};
+    else
+        geometries_.push_back(Entry{ea::move(cooked), nullptr});
+    return true;
+}
+
+const CookedCollisionGeometryData* CookedCollisionGeometry::GetCookedData(ShapeType shapeType, unsigned lodLevel) const
+{
+    const Entry* entry = const_cast<CookedCollisionGeometry*>(this)->FindEntry(shapeType, lodLevel);
+    return entry ? &entry->cooked_ : nullptr;
+}
+
+CollisionGeometryData* CookedCollisionGeometry::GetGeometryData(ShapeType shapeType, unsigned lodLevel)
+{
+    Entry* entry = FindEntry(shapeType, lodLevel);
+    if (!entry)
+        return nullptr;
+
+    if (!entry->geometryData_)
+    {
+        switch (shapeType)
+        {
+        case SHAPE_TRIANGLEMESH:
+            entry->geometryData_ = MakeShared<TriangleMeshData>(entry->cooked_);
+            break;
+        case SHAPE_CONVEXHULL:
+            entry->geometryData_ = MakeShared<ConvexData>(entry->cooked_);
+            break;
+        case SHAPE_GIMPACTMESH:
+            entry->geometryData_ = MakeShared<GImpactMeshData>(entry->cooked_);
+            break;
+        default:
+            break;
+        }
+    }
+    return entry->geometryData_;
+}
+
+ea::string CookedCollisionGeometry::GetResourceName(const ea::string& modelName)
+{
+    return ReplaceExtension(modelName, ".collision");
+}
+
+CookedCollisionGeometry::Entry* CookedCollisionGeometry::FindEntry(ShapeType shapeType, unsigned lodLevel)
+{
+    for (Entry& entry : geometries_)
+    {
+        if (entry.cooked_.shapeType_ == shapeType && entry.cooked_.lodLevel_ == lodLevel)
+            return &entry;
+    }
+    return nullptr;
+}
+
+}
@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2022-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Math/Vector3.h"
+#include "../Physics/CollisionShape.h"
+#include "../Resource/Resource.h"
+
+namespace Urho3D
+{
+
+class Model;
+
+/// Cooked internal edge info of one triangle.
+struct CookedTriangleInfo
+{
+    /// Edge flags.
+    int flags_{};
+    /// Edge angles: V0V1, V1V2, V2V0.
+    Vector3 edgeAngles_;
+};
+
+/// Collision geometry of one shape type and LOD level, ready to be used without rebuilding.
+struct URHO3D_API CookedCollisionGeometryData
+{
+    /// Shape type.
+    ShapeType shapeType_{};
+    /// Model LOD level.
+    unsigned lodLevel_{};
+    /// Vertices of triangle mesh or convex hull.
+    ea::vector<Vector3> vertices_;
+    /// Triangle indices of triangle mesh or convex hull.
+    ea::vector<unsigned> indices_;
+    /// Whether the triangle mesh BVH is quantized.
+    bool useQuantize_{};
+    /// Serialized triangle mesh BVH.
+    ea::vector<unsigned char> bvhData_;
+    /// Keys of triangle mesh internal edge info.
+    ea::vector<int> triangleInfoKeys_;
+    /// Triangle mesh internal edge info.
+    ea::vector<CookedTriangleInfo> triangleInfos_;
+};
+
+/// Collision geometry cooked from a model by asset pipeline.
+/// Collision shapes use it instead of building BVH and convex hulls from the model on load.
+/// Geometry data is shared by all collision shapes using the model, regardless of physics world.
+class URHO3D_API CookedCollisionGeometry : public Resource
+{
+    URHO3D_OBJECT(CookedCollisionGeometry, Resource);
+
+public:
+    /// Construct.
+    explicit CookedCollisionGeometry(Context* context);
+    /// Destruct.
+    ~CookedCollisionGeometry() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Load resource from stream. May be called from a worker thread. Return true if successful.
+    bool BeginLoad(Deserializer& source) override;
+    /// Save resource. Return true if successful.
+    bool Save(Serializer& dest) const override;
+
+    /// Cook geometry of the model for given shape type and LOD level. Return true if successful.
+    bool CookGeometry(ShapeType shapeType, Model* model, unsigned lodLevel);
+    /// Return cooked geometry for given shape type and LOD level, or null if not cooked.
+    const CookedCollisionGeometryData* GetCookedData(ShapeType shapeType, unsigned lodLevel) const;
+    /// Return geometry data for given shape type and LOD level, or null if not cooked. Created on first use.
+    CollisionGeometryData* GetGeometryData(ShapeType shapeType, unsigned lodLevel);
+    /// Return number of cooked geometries.
+    unsigned GetNumGeometries() const { return geometries_.size(); }
+
+    /// Return name of cooked collision geometry resource for the model.
+    static ea::string GetResourceName(const ea::string& modelName);
+
+private:
+    /// Cooked geometry and geometry data created from it.
+    struct Entry
+    {
+        CookedCollisionGeometryData cooked_;
+        SharedPtr<CollisionGeometryData> geometryData_;
+    };
+
+    /// Find entry by shape type and LOD level.
+    Entry* FindEntry(ShapeType shapeType, unsigned lodLevel);
+
+    /// Cooked geometries.
+    ea::vector<Entry> geometries_;
+};
+
+}
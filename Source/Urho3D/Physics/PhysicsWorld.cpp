@@ -27,13 +27,16 @@
 #include "../Core/Context.h"
 #include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Model.h"
 #include "../IO/Log.h"
 #include "../Math/Ray.h"
 #include "../Physics/KinematicCharacterController.h"
 #include "../Physics/CollisionShape.h"
+#include "../Physics/CollisionGeometryCooker.h"
 #include "../Physics/Constraint.h"
+#include "../Physics/CookedCollisionGeometry.h"
 #include "../Physics/PhysicsEvents.h"
 #include "../Physics/PhysicsUtils.h"
 #include "../Physics/PhysicsWorld.h"
@@ -43,61 +46,180 @@
 #include "../Scene/SceneEvents.h"
 
 #include <Bullet/BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
+#include <Bullet/BulletCollision/CollisionDispatch/btCollisionDispatcherMt.h>
 #include <Bullet/BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h>
 #include <Bullet/BulletCollision/CollisionDispatch/btInternalEdgeUtility.h>
 #include <Bullet/BulletCollision/CollisionShapes/btBoxShape.h>
 #include <Bullet/BulletCollision/CollisionShapes/btSphereShape.h>
 #include <Bullet/BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h>
 #include <Bullet/BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h>
+#include <Bullet/BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolverMt.h>
 #include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+#include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <Bullet/LinearMath/btThreads.h>
 #include <BulletCollision/CollisionDispatch/btGhostObject.h>
 
 extern ContactAddedCallback gContactAddedCallback;
 
+template <class T>
 ATTRIBUTE_ALIGNED16(class)
-btCustomDiscreteDynamicsWorld : public btDiscreteDynamicsWorld
+btCustomDynamicsWorld : public T
 {
 public:
-    using btDiscreteDynamicsWorld::btDiscreteDynamicsWorld;
+    using T::T;
 
     void customStepSimulation(unsigned clampedSimulationSteps, btScalar fixedTimeStep, btScalar overtime)
     {
-        m_fixedTimeStep = fixedTimeStep;
-        m_localTime = overtime;
+        this->m_fixedTimeStep = fixedTimeStep;
+        this->m_localTime = overtime;
 
-        if (getDebugDrawer())
+        if (this->getDebugDrawer())
         {
-            btIDebugDraw* debugDrawer = getDebugDrawer();
+            btIDebugDraw* debugDrawer = this->getDebugDrawer();
             gDisableDeactivation = (debugDrawer->getDebugMode() & btIDebugDraw::DBG_NoDeactivation) != 0;
         }
 
         if (clampedSimulationSteps > 0)
         {
-            saveKinematicState(fixedTimeStep * clampedSimulationSteps);
+            this->saveKinematicState(fixedTimeStep * clampedSimulationSteps);
 
             for (int i = 0; i < clampedSimulationSteps; i++)
             {
                 // Urho3D: apply gravity on each substep
-                applyGravity();
+                this->applyGravity();
 
-                internalSingleStepSimulation(fixedTimeStep);
-                synchronizeMotionStates();
+                this->internalSingleStepSimulation(fixedTimeStep);
+                this->synchronizeMotionStates();
 
                 // Urho3D: clear forces on each substep
-                clearForces();
+                this->clearForces();
             }
         }
         else
         {
-            synchronizeMotionStates();
+            this->synchronizeMotionStates();
         }
 
-        clearForces();
+        this->clearForces();
     }
 
-    btScalar getLocalTime() const { return m_localTime; }
+    btScalar getLocalTime() const { return this->m_localTime; }
+
+    void synchronizeMotionStates() override
+    {
+        T::synchronizeMotionStates();
+
+        // Urho3D: motion states only collect transforms, apply them to scene nodes in one pass
+        static_cast<Urho3D::PhysicsWorld*>(this->getWorldUserInfo())->ApplyPendingWorldTransforms();
+    }
+
+protected:
+    void createPredictiveContacts(btScalar timeStep) override
+    {
+        // Urho3D: collision dispatcher cannot create manifolds from multiple threads outside of narrowphase
+        btDiscreteDynamicsWorld::createPredictiveContacts(timeStep);
+    }
 };
 
+using btCustomDiscreteDynamicsWorld = btCustomDynamicsWorld<btDiscreteDynamicsWorld>;
+using btCustomDiscreteDynamicsWorldMt = btCustomDynamicsWorld<btDiscreteDynamicsWorldMt>;
+
+#if BT_THREADSAFE
+// Defined in btThreads.cpp, used to detect nested parallel loops
+void btPushThreadsAreRunning();
+void btPopThreadsAreRunning();
+
+/// Bullet task scheduler that runs parallel loops in WorkQueue threads.
+class btWorkQueueTaskScheduler : public btITaskScheduler
+{
+public:
+    btWorkQueueTaskScheduler() : btITaskScheduler("WorkQueue") {}
+
+    void setWorkQueue(Urho3D::WorkQueue* workQueue) { workQueue_ = workQueue; }
+
+    // Bullet assigns thread indices on first use, so any thread may get any index
+    int getMaxNumThreads() const override { return BT_MAX_THREAD_COUNT; }
+    int getNumThreads() const override { return BT_MAX_THREAD_COUNT; }
+    void setNumThreads(int numThreads) override {}
+
+    void parallelFor(int iBegin, int iEnd, int grainSize, const btIParallelForBody& body) override
+    {
+        Urho3D::WorkQueue* workQueue = workQueue_;
+        if (!workQueue || iEnd - iBegin <= grainSize)
+        {
+            body.forLoop(iBegin, iEnd);
+            return;
+        }
+
+        btPushThreadsAreRunning();
+        const auto bucket = static_cast<unsigned>(ea::max(grainSize, 1));
+        const auto size = static_cast<unsigned>(iEnd - iBegin);
+        Urho3D::ForEachParallel(workQueue, bucket, size,
+            [&](unsigned beginIndex, unsigned endIndex) { body.forLoop(iBegin + beginIndex, iBegin + endIndex); });
+        btPopThreadsAreRunning();
+    }
+
+    btScalar parallelSum(int iBegin, int iEnd, int grainSize, const btIParallelSumBody& body) override
+    {
+        Urho3D::WorkQueue* workQueue = workQueue_;
+        if (!workQueue || iEnd - iBegin <= grainSize)
+            return body.sumLoop(iBegin, iEnd);
+
+        const auto bucket = static_cast<unsigned>(ea::max(grainSize, 1));
+        const auto size = static_cast<unsigned>(iEnd - iBegin);
+        ea::vector<btScalar> threadSums(Urho3D::WorkQueue::GetThreadIndexCount(), btScalar(0));
+        btPushThreadsAreRunning();
+        Urho3D::ForEachParallel(workQueue, bucket, size, [&](unsigned beginIndex, unsigned endIndex)
+        {
+            threadSums[Urho3D::WorkQueue::GetThreadIndex()] += body.sumLoop(iBegin + beginIndex, iBegin + endIndex);
+        });
+        btPopThreadsAreRunning();
+
+        btScalar sum = 0;
+        for (btScalar threadSum : threadSums)
+            sum += threadSum;
+        return sum;
+    }
+
+private:
+    Urho3D::WeakPtr<Urho3D::WorkQueue> workQueue_;
+};
+
+/// Multithreaded collision dispatcher that keeps order of contact manifolds independent from thread timing.
+class btDeterministicCollisionDispatcherMt : public btCollisionDispatcherMt
+{
+public:
+    using btCollisionDispatcherMt::btCollisionDispatcherMt;
+
+    void dispatchAllCollisionPairs(btOverlappingPairCache* pairCache, const btDispatcherInfo& info, btDispatcher* dispatcher) override
+    {
+        const int oldNumManifolds = m_manifoldsPtr.size();
+        btCollisionDispatcherMt::dispatchAllCollisionPairs(pairCache, info, dispatcher);
+
+        // New manifolds are appended in order of threads. Sort them by bodies, the pair of bodies is unique.
+        // Manifolds of the same pair are created by the same thread, stable sort keeps them in order.
+        if (m_manifoldsPtr.size() > oldNumManifolds + 1)
+        {
+            const auto getKey = [](const btPersistentManifold* manifold)
+            {
+                const int index0 = manifold->getBody0()->getWorldArrayIndex();
+                const int index1 = manifold->getBody1()->getWorldArrayIndex();
+                return ea::make_pair(ea::min(index0, index1), ea::max(index0, index1));
+            };
+            const auto isLess = [&](const btPersistentManifold* lhs, const btPersistentManifold* rhs)
+            {
+                return getKey(lhs) < getKey(rhs);
+            };
+            btPersistentManifold** manifolds = &m_manifoldsPtr[0];
+            ea::stable_sort(manifolds + oldNumManifolds, manifolds + m_manifoldsPtr.size(), isLess);
+
+            for (int i = oldNumManifolds; i < m_manifoldsPtr.size(); ++i)
+                m_manifoldsPtr[i]->m_index1a = i;
+        }
+    }
+};
+#endif
+
 namespace Urho3D
 {
 
@@ -111,6 +233,23 @@ static bool CompareRaycastResults(const PhysicsRaycastResult& lhs, const Physics
     return lhs.distance_ < rhs.distance_;
 }
 
+static void CustomStepSimulation(
+    btDiscreteDynamicsWorld* world, bool multithreaded, unsigned numSteps, float fixedTimeStep, float overtime)
+{
+    if (multithreaded)
+        static_cast<btCustomDiscreteDynamicsWorldMt*>(world)->customStepSimulation(numSteps, fixedTimeStep, overtime);
+    else
+        static_cast<btCustomDiscreteDynamicsWorld*>(world)->customStepSimulation(numSteps, fixedTimeStep, overtime);
+}
+
+static float GetLocalTime(btDiscreteDynamicsWorld* world, bool multithreaded)
+{
+    if (multithreaded)
+        return static_cast<btCustomDiscreteDynamicsWorldMt*>(world)->getLocalTime();
+    else
+        return static_cast<btCustomDiscreteDynamicsWorld*>(world)->getLocalTime();
+}
+
 void InternalPreTickCallback(btDynamicsWorld* world, btScalar timeStep)
 {
     static_cast<PhysicsWorld*>(world->getWorldUserInfo())->PreStep(timeStep);
@@ -189,6 +328,74 @@ struct PhysicsQueryCallback : public btCollisionWorld::ContactResultCallback
     unsigned collisionMask_;
 };
 
+/// Minimal number of batched queries processed by one task.
+static const unsigned BATCH_QUERY_BUCKET_SIZE = 16;
+
+/// Empty result of physics query.
+static void ResetRaycastResult(PhysicsRaycastResult& result)
+{
+    result.position_ = Vector3::ZERO;
+    result.normal_ = Vector3::ZERO;
+    result.distance_ = M_INFINITY;
+    result.hitFraction_ = 0.0f;
+    result.body_ = nullptr;
+}
+
+/// Adapter of callback to broadphase tree.
+template <class T>
+struct BroadphaseLeafCallback : public btDbvt::ICollide
+{
+    explicit BroadphaseLeafCallback(const T& callback) : callback_(callback) {}
+
+    void Process(const btDbvtNode* leaf) override
+    {
+        auto proxy = static_cast<btBroadphaseProxy*>(leaf->data);
+        callback_(static_cast<btCollisionObject*>(proxy->m_clientObject));
+    }
+
+    const T& callback_;
+};
+
+/// Traverse broadphase along the swept box. Unlike btCollisionWorld::rayTest, it's thread-safe without allocations.
+template <class T>
+static void TraverseBroadphaseRay(btDbvtBroadphase* broadphase, const btVector3& rayFrom, const btVector3& rayTo,
+    const btVector3& aabbMin, const btVector3& aabbMax, const T& callback)
+{
+    thread_local btAlignedObjectArray<const btDbvtNode*> stack;
+
+    btVector3 rayDirection = rayTo - rayFrom;
+    rayDirection.normalize();
+
+    btVector3 rayDirectionInverse;
+    unsigned signs[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        rayDirectionInverse[i] = rayDirection[i] == 0.0f ? btScalar(BT_LARGE_FLOAT) : 1.0f / rayDirection[i];
+        signs[i] = rayDirectionInverse[i] < 0.0f;
+    }
+    const btScalar lambdaMax = rayDirection.dot(rayTo - rayFrom);
+
+    BroadphaseLeafCallback<T> leafCallback(callback);
+    for (btDbvt& tree : broadphase->m_sets)
+    {
+        tree.rayTestInternal(tree.m_root, rayFrom, rayTo, rayDirectionInverse, signs, lambdaMax, aabbMin, aabbMax,
+            stack, leafCallback);
+    }
+}
+
+/// Traverse broadphase within the box.
+template <class T>
+static void TraverseBroadphaseBox(btDbvtBroadphase* broadphase, const btVector3& aabbMin, const btVector3& aabbMax,
+    const T& callback)
+{
+    thread_local btAlignedObjectArray<const btDbvtNode*> stack;
+
+    const btDbvtVolume volume = btDbvtVolume::FromMM(aabbMin, aabbMax);
+    BroadphaseLeafCallback<T> leafCallback(callback);
+    for (btDbvt& tree : broadphase->m_sets)
+        tree.collideTVNoStackAlloc(tree.m_root, volume, stack, leafCallback);
+}
+
 PhysicsWorld::PhysicsWorld(Context* context) :
     Component(context),
     fps_(DEFAULT_FPS),
@@ -201,12 +408,10 @@ PhysicsWorld::PhysicsWorld(Context* context) :
     else
         collisionConfiguration_ = new btDefaultCollisionConfiguration();
 
-    collisionDispatcher_ = ea::make_unique<btCollisionDispatcher>(collisionConfiguration_);
-    btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(collisionDispatcher_.get()));
-
     broadphase_ = ea::make_unique<btDbvtBroadphase>();
-    solver_ = ea::make_unique<btSequentialImpulseConstraintSolver>();
-    world_ = ea::make_unique<btCustomDiscreteDynamicsWorld>(collisionDispatcher_.get(), broadphase_.get(), solver_.get(), collisionConfiguration_);
+    if (!PhysicsWorld::config.multithreaded_ || !CreateMultithreadedWorld(PhysicsWorld::config.deterministic_))
+        CreateSingleThreadedWorld();
+    btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(collisionDispatcher_.get()));
 
     world_->setGravity(ToBtVector3(DEFAULT_GRAVITY));
     world_->getDispatchInfo().m_useContinuous = true;
@@ -237,6 +442,7 @@ PhysicsWorld::~PhysicsWorld()
     }
 
     world_.reset();
+    solverMt_.reset();
     solver_.reset();
     broadphase_.reset();
     collisionDispatcher_.reset();
@@ -255,6 +461,49 @@ PhysicsWorld::~PhysicsWorld()
     }
 }
 
+bool PhysicsWorld::CreateMultithreadedWorld(bool deterministic)
+{
+#if BT_THREADSAFE
+    // Scheduler is global in Bullet, all multithreaded worlds share it
+    static btWorkQueueTaskScheduler taskScheduler;
+
+    auto workQueue = GetSubsystem<WorkQueue>();
+    taskScheduler.setWorkQueue(workQueue);
+    if (btGetTaskScheduler() != &taskScheduler)
+        btSetTaskScheduler(&taskScheduler);
+
+    if (deterministic)
+        collisionDispatcher_ = ea::make_unique<btDeterministicCollisionDispatcherMt>(collisionConfiguration_);
+    else
+        collisionDispatcher_ = ea::make_unique<btCollisionDispatcherMt>(collisionConfiguration_);
+
+    const unsigned numSolvers = workQueue ? workQueue->GetNumProcessingThreads() : 1;
+    auto solverPool = ea::make_unique<btConstraintSolverPoolMt>(static_cast<int>(numSolvers));
+
+    // Solver for large islands splits constraints into batches, results depend on thread timing
+    if (!deterministic)
+        solverMt_ = ea::make_unique<btSequentialImpulseConstraintSolverMt>();
+
+    world_ = ea::make_unique<btCustomDiscreteDynamicsWorldMt>(
+        collisionDispatcher_.get(), broadphase_.get(), solverPool.get(), solverMt_.get(), collisionConfiguration_);
+    solver_ = ea::move(solverPool);
+    multithreaded_ = true;
+    return true;
+#else
+    URHO3D_LOGWARNING("Multithreaded physics is not supported without URHO3D_THREADING");
+    return false;
+#endif
+}
+
+void PhysicsWorld::CreateSingleThreadedWorld()
+{
+    collisionDispatcher_ = ea::make_unique<btCollisionDispatcher>(collisionConfiguration_);
+    solver_ = ea::make_unique<btSequentialImpulseConstraintSolver>();
+    world_ = ea::make_unique<btCustomDiscreteDynamicsWorld>(
+        collisionDispatcher_.get(), broadphase_.get(), solver_.get(), collisionConfiguration_);
+    multithreaded_ = false;
+}
+
 void PhysicsWorld::RegisterObject(Context* context)
 {
     context->AddFactoryReflection<PhysicsWorld>(Category_Subsystem);
@@ -341,7 +590,7 @@ void PhysicsWorld::Update(float timeStep)
         }
     }
 
-    PostUpdate(timeStep, world_->getLocalTime());
+    PostUpdate(timeStep, GetLocalTime(world_.get(), multithreaded_));
     simulating_ = false;
     ApplyDelayedWorldTransforms();
 }
@@ -379,7 +628,7 @@ void PhysicsWorld::CustomUpdate(unsigned numSteps, float fixedTimeStep, float ov
 
     timeAcc_ = overtime;
     synchronizedStep_ = sync;
-    world_->customStepSimulation(numSteps, fixedTimeStep, overtime);
+    CustomStepSimulation(world_.get(), multithreaded_, numSteps, fixedTimeStep, overtime);
 
     PostUpdate(timeStep, overtime);
     simulating_ = false;
@@ -679,6 +928,182 @@ void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, btCollisionShape* sh
     }
 }
 
+template <class T>
+void PhysicsWorld::ProcessBatchQueries(unsigned numQueries, const T& callback)
+{
+#if BT_THREADSAFE
+    // Broadphase and collision objects are not modified during the call, so queries can be processed in parallel
+    auto workQueue = GetSubsystem<WorkQueue>();
+    if (workQueue)
+    {
+        ForEachParallel(workQueue, BATCH_QUERY_BUCKET_SIZE, numQueries,
+            [&](unsigned beginIndex, unsigned endIndex)
+        {
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+                callback(i);
+        });
+        return;
+    }
+#endif
+
+    for (unsigned i = 0; i < numQueries; ++i)
+        callback(i);
+}
+
+void PhysicsWorld::RaycastSingleBatch(ea::span<const PhysicsRaycastQuery> queries, ea::span<PhysicsRaycastResult> results)
+{
+    URHO3D_PROFILE("PhysicsRaycastSingleBatch");
+
+    if (queries.size() != results.size())
+    {
+        URHO3D_LOGERROR("Number of raycast results doesn't match number of queries");
+        return;
+    }
+
+    if (simulating_)
+    {
+        URHO3D_LOGERROR("Batched physics queries cannot be performed during simulation");
+        return;
+    }
+
+    auto broadphase = static_cast<btDbvtBroadphase*>(broadphase_.get());
+    ProcessBatchQueries(queries.size(), [&](unsigned index)
+    {
+        const PhysicsRaycastQuery& query = queries[index];
+        PhysicsRaycastResult& result = results[index];
+        ResetRaycastResult(result);
+        if (query.maxDistance_ <= 0.0f)
+            return;
+
+        const btVector3 rayFrom = ToBtVector3(query.ray_.origin_);
+        const btVector3 rayTo = ToBtVector3(query.ray_.origin_ + query.maxDistance_ * query.ray_.direction_);
+        const btTransform rayFromTransform{btQuaternion::getIdentity(), rayFrom};
+        const btTransform rayToTransform{btQuaternion::getIdentity(), rayTo};
+
+        btCollisionWorld::ClosestRayResultCallback rayCallback(rayFrom, rayTo);
+        rayCallback.m_collisionFilterGroup = (short)0xffff;
+        rayCallback.m_collisionFilterMask = (short)query.collisionMask_;
+
+        const btVector3 zero{0.0f, 0.0f, 0.0f};
+        TraverseBroadphaseRay(broadphase, rayFrom, rayTo, zero, zero, [&](btCollisionObject* collisionObject)
+        {
+            if (rayCallback.needsCollision(collisionObject->getBroadphaseHandle()))
+            {
+                btCollisionWorld::rayTestSingle(rayFromTransform, rayToTransform, collisionObject,
+                    collisionObject->getCollisionShape(), collisionObject->getWorldTransform(), rayCallback);
+            }
+        });
+
+        if (rayCallback.hasHit())
+        {
+            result.position_ = ToVector3(rayCallback.m_hitPointWorld);
+            result.normal_ = ToVector3(rayCallback.m_hitNormalWorld);
+            result.distance_ = (result.position_ - query.ray_.origin_).Length();
+            result.hitFraction_ = rayCallback.m_closestHitFraction;
+            result.body_ = static_cast<RigidBody*>(rayCallback.m_collisionObject->getUserPointer());
+        }
+    });
+}
+
+void PhysicsWorld::SphereCastBatch(ea::span<const PhysicsSphereCastQuery> queries, ea::span<PhysicsRaycastResult> results)
+{
+    URHO3D_PROFILE("PhysicsSphereCastBatch");
+
+    if (queries.size() != results.size())
+    {
+        URHO3D_LOGERROR("Number of sphere cast results doesn't match number of queries");
+        return;
+    }
+
+    if (simulating_)
+    {
+        URHO3D_LOGERROR("Batched physics queries cannot be performed during simulation");
+        return;
+    }
+
+    auto broadphase = static_cast<btDbvtBroadphase*>(broadphase_.get());
+    ProcessBatchQueries(queries.size(), [&](unsigned index)
+    {
+        const PhysicsSphereCastQuery& query = queries[index];
+        PhysicsRaycastResult& result = results[index];
+        ResetRaycastResult(result);
+        if (query.maxDistance_ <= 0.0f)
+            return;
+
+        const btSphereShape shape(query.radius_);
+        const btVector3 startPos = ToBtVector3(query.ray_.origin_);
+        const btVector3 endPos = ToBtVector3(query.ray_.origin_ + query.maxDistance_ * query.ray_.direction_);
+        const btTransform startTransform{btQuaternion::getIdentity(), startPos};
+        const btTransform endTransform{btQuaternion::getIdentity(), endPos};
+
+        btCollisionWorld::ClosestConvexResultCallback convexCallback(startPos, endPos);
+        convexCallback.m_collisionFilterGroup = (short)0xffff;
+        convexCallback.m_collisionFilterMask = (short)query.collisionMask_;
+
+        const btVector3 halfSize{query.radius_, query.radius_, query.radius_};
+        TraverseBroadphaseRay(broadphase, startPos, endPos, -halfSize, halfSize, [&](btCollisionObject* collisionObject)
+        {
+            if (convexCallback.needsCollision(collisionObject->getBroadphaseHandle()))
+            {
+                // No allowed penetration, same as convexSweepTest used by SphereCast
+                btCollisionWorld::objectQuerySingle(&shape, startTransform, endTransform, collisionObject,
+                    collisionObject->getCollisionShape(), collisionObject->getWorldTransform(), convexCallback, 0.0f);
+            }
+        });
+
+        if (convexCallback.hasHit())
+        {
+            result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
+            result.position_ = ToVector3(convexCallback.m_hitPointWorld);
+            result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
+            result.distance_ = convexCallback.m_closestHitFraction * query.maxDistance_;
+            result.hitFraction_ = convexCallback.m_closestHitFraction;
+        }
+    });
+}
+
+void PhysicsWorld::GetRigidBodiesBatch(ea::span<const PhysicsOverlapQuery> queries, ea::span<RigidBody*> results,
+    ea::span<unsigned> numResults, unsigned maxResultsPerQuery)
+{
+    URHO3D_PROFILE("PhysicsOverlapBatch");
+
+    if (queries.size() != numResults.size() || queries.size() * maxResultsPerQuery != results.size())
+    {
+        URHO3D_LOGERROR("Number of overlap results doesn't match number of queries");
+        return;
+    }
+
+    if (simulating_)
+    {
+        URHO3D_LOGERROR("Batched physics queries cannot be performed during simulation");
+        return;
+    }
+
+    auto broadphase = static_cast<btDbvtBroadphase*>(broadphase_.get());
+    ProcessBatchQueries(queries.size(), [&](unsigned index)
+    {
+        const PhysicsOverlapQuery& query = queries[index];
+        const auto queryResults = results.subspan(index * maxResultsPerQuery, maxResultsPerQuery);
+        unsigned& numQueryResults = numResults[index];
+        numQueryResults = 0;
+
+        const Sphere& sphere = query.sphere_;
+        const btVector3 halfSize{sphere.radius_, sphere.radius_, sphere.radius_};
+        const btVector3 center = ToBtVector3(sphere.center_);
+        TraverseBroadphaseBox(broadphase, center - halfSize, center + halfSize, [&](btCollisionObject* collisionObject)
+        {
+            auto body = static_cast<RigidBody*>(collisionObject->getUserPointer());
+            if (!body || numQueryResults >= maxResultsPerQuery || !(body->GetCollisionLayer() & query.collisionMask_))
+                return;
+
+            const btBroadphaseProxy* proxy = collisionObject->getBroadphaseHandle();
+            const BoundingBox boundingBox{ToVector3(proxy->m_aabbMin), ToVector3(proxy->m_aabbMax)};
+            if (sphere.IsInside(boundingBox) != OUTSIDE)
+                queryResults[numQueryResults++] = body;
+        });
+    });
+}
+
 void PhysicsWorld::RemoveCachedGeometry(Model* model)
 {
     RemoveCachedGeometryImpl(triMeshCache_, model);
@@ -820,6 +1245,38 @@ void PhysicsWorld::AddDelayedWorldTransform(const DelayedWorldTransform& transfo
     delayedWorldTransforms_[transform.rigidBody_] = transform;
 }
 
+void PhysicsWorld::AddPendingWorldTransform(RigidBody* body, const Vector3& worldPosition, const Quaternion& worldRotation)
+{
+    DelayedWorldTransform& transform = pendingWorldTransforms_.push_back();
+    transform.rigidBody_ = body;
+    transform.parentRigidBody_ = nullptr;
+    transform.worldPosition_ = worldPosition;
+    transform.worldRotation_ = worldRotation;
+}
+
+void PhysicsWorld::ApplyPendingWorldTransforms()
+{
+    if (pendingWorldTransforms_.empty())
+        return;
+
+    URHO3D_PROFILE("ApplyPhysicsTransforms");
+
+    Scene* scene = GetScene();
+    for (DelayedWorldTransform& transform : pendingWorldTransforms_)
+    {
+        // If the rigid body is parented to another rigid body, can not set the transform immediately
+        Node* parent = transform.rigidBody_->GetNode()->GetParent();
+        if (parent && parent != scene)
+            transform.parentRigidBody_ = parent->GetComponent<RigidBody>();
+
+        if (transform.parentRigidBody_)
+            AddDelayedWorldTransform(transform);
+        else
+            transform.rigidBody_->ApplyWorldTransform(transform.worldPosition_, transform.worldRotation_);
+    }
+    pendingWorldTransforms_.clear();
+}
+
 void PhysicsWorld::DrawDebugGeometry(bool depthTest)
 {
     auto* debug = GetComponent<DebugRenderer>();
@@ -1182,6 +1639,8 @@ void RegisterPhysicsLibrary(Context* context)
     PhysicsWorld::RegisterObject(context);
     RaycastVehicle::RegisterObject(context);
     KinematicCharacterController::RegisterObject(context);
+    CookedCollisionGeometry::RegisterObject(context);
+    CollisionGeometryCooker::RegisterObject(context);
 }
 
 }
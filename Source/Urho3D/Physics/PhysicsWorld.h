@@ -26,6 +26,7 @@
 
 #include "../IO/VectorBuffer.h"
 #include "../Math/BoundingBox.h"
+#include "../Math/Ray.h"
 #include "../Math/Sphere.h"
 #include "../Math/Vector3.h"
 #include "../Replica/NetworkId.h"
@@ -41,13 +42,13 @@
 #endif
 
 #include <EASTL/optional.h>
+#include <EASTL/span.h>
 
 class btCollisionConfiguration;
 class btCollisionShape;
 class btBroadphaseInterface;
 class btConstraintSolver;
 class btDiscreteDynamicsWorld;
-class btCustomDiscreteDynamicsWorld;
 class btDispatcher;
 class btDynamicsWorld;
 class btPersistentManifold;
@@ -61,7 +62,6 @@ class Deserializer;
 class Constraint;
 class Model;
 class Node;
-class Ray;
 class RigidBody;
 class Scene;
 class Serializer;
@@ -96,6 +96,39 @@ struct URHO3D_API PhysicsRaycastResult
     RigidBody* body_{};
 };
 
+/// Raycast query for batched physics queries.
+struct PhysicsRaycastQuery
+{
+    /// Ray in world space.
+    Ray ray_;
+    /// Max distance along the ray.
+    float maxDistance_{};
+    /// Collision mask of the query.
+    unsigned collisionMask_{M_MAX_UNSIGNED};
+};
+
+/// Swept sphere query for batched physics queries.
+struct PhysicsSphereCastQuery
+{
+    /// Ray in world space.
+    Ray ray_;
+    /// Radius of the sphere.
+    float radius_{};
+    /// Max distance along the ray.
+    float maxDistance_{};
+    /// Collision mask of the query.
+    unsigned collisionMask_{M_MAX_UNSIGNED};
+};
+
+/// Overlap query for batched physics queries. Returns rigid bodies whose bounding boxes intersect the sphere.
+struct PhysicsOverlapQuery
+{
+    /// Sphere in world space.
+    Sphere sphere_;
+    /// Collision mask of the query.
+    unsigned collisionMask_{M_MAX_UNSIGNED};
+};
+
 /// Delayed world transform assignment for parented rigidbodies.
 struct DelayedWorldTransform
 {
@@ -135,6 +168,12 @@ struct PhysicsWorldConfig
 
     /// Override for the collision configuration (default btDefaultCollisionConfiguration).
     btCollisionConfiguration* collisionConfig_;
+    /// Whether to run narrowphase, island solving and integration in WorkQueue threads.
+    /// Requires URHO3D_THREADING, ignored otherwise.
+    bool multithreaded_{};
+    /// Whether multithreaded simulation should produce the same results regardless of thread count and timing.
+    /// Results still differ from the single-threaded simulation. Large islands are not split between threads.
+    bool deterministic_{true};
 };
 
 static const int DEFAULT_FPS = 60;
@@ -230,6 +269,19 @@ public:
     /// Perform a physics world swept convex test using a user-supplied Bullet collision shape and return the first hit.
     void ConvexCast(PhysicsRaycastResult& result, btCollisionShape* shape, const Vector3& startPos, const Quaternion& startRot,
         const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Perform multiple closest-hit raycasts in WorkQueue threads. Results are stored by query index.
+    /// Should not be called during simulation. Rigid bodies must not be changed until the call returns.
+    /// @nobind
+    void RaycastSingleBatch(ea::span<const PhysicsRaycastQuery> queries, ea::span<PhysicsRaycastResult> results);
+    /// Perform multiple swept sphere tests in WorkQueue threads. Results are stored by query index.
+    /// @nobind
+    void SphereCastBatch(ea::span<const PhysicsSphereCastQuery> queries, ea::span<PhysicsRaycastResult> results);
+    /// Perform multiple overlap queries in WorkQueue threads.
+    /// Each query has maxResultsPerQuery consecutive elements in results. Extra bodies are ignored.
+    /// Number of found bodies for each query is stored in numResults.
+    /// @nobind
+    void GetRigidBodiesBatch(ea::span<const PhysicsOverlapQuery> queries, ea::span<RigidBody*> results,
+        ea::span<unsigned> numResults, unsigned maxResultsPerQuery);
     /// Invalidate cached collision geometry for a model.
     void RemoveCachedGeometry(Model* model);
     /// Return rigid bodies by a sphere query.
@@ -290,6 +342,11 @@ public:
     void RemoveConstraint(Constraint* constraint);
     /// Add a delayed world transform assignment. Called by RigidBody.
     void AddDelayedWorldTransform(const DelayedWorldTransform& transform);
+    /// Add world transform received from simulation. Called by RigidBody.
+    void AddPendingWorldTransform(RigidBody* body, const Vector3& worldPosition, const Quaternion& worldRotation);
+    /// Apply world transforms received from simulation to scene nodes. Called after each simulation step.
+    /// @nobind
+    void ApplyPendingWorldTransforms();
     /// Add debug geometry to the debug renderer.
     void DrawDebugGeometry(bool depthTest);
     /// Set debug renderer to use. Called both by PhysicsWorld itself and physics components.
@@ -320,6 +377,8 @@ public:
 
     /// Return whether is currently inside the Bullet substep loop.
     bool IsSimulating() const { return simulating_; }
+    /// Return whether the simulation is multithreaded.
+    bool IsMultithreaded() const { return multithreaded_; }
 
     /// Overrides of the internal configuration.
     static struct PhysicsWorldConfig config;
@@ -341,7 +400,13 @@ private:
     void PostStep(float timeStep);
     /// Send accumulated collision events.
     void SendCollisionEvents();
+    /// Invoke callback for each batched query, in parallel if possible.
+    template <class T> void ProcessBatchQueries(unsigned numQueries, const T& callback);
     void ApplyDelayedWorldTransforms();
+    /// Create multithreaded Bullet world. Return false if not supported.
+    bool CreateMultithreadedWorld(bool deterministic);
+    /// Create single-threaded Bullet world.
+    void CreateSingleThreadedWorld();
 
     /// Bullet collision configuration.
     btCollisionConfiguration* collisionConfiguration_{};
@@ -349,10 +414,12 @@ private:
     ea::unique_ptr<btDispatcher> collisionDispatcher_;
     /// Bullet collision broadphase.
     ea::unique_ptr<btBroadphaseInterface> broadphase_;
-    /// Bullet constraint solver.
+    /// Bullet constraint solver. Pool of solvers in multithreaded mode.
     ea::unique_ptr<btConstraintSolver> solver_;
+    /// Bullet constraint solver for large islands in multithreaded mode.
+    ea::unique_ptr<btConstraintSolver> solverMt_;
     /// Bullet physics world.
-    ea::unique_ptr<btCustomDiscreteDynamicsWorld> world_;
+    ea::unique_ptr<btDiscreteDynamicsWorld> world_;
     /// Extra weak pointer to scene to allow for cleanup in case the world is destroyed before other components.
     WeakPtr<Scene> scene_;
     /// Rigid bodies in the world.
@@ -365,6 +432,8 @@ private:
     ea::unordered_map<ea::pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, ManifoldPair> currentCollisions_;
     /// Collision pairs on the previous frame. Used to check if a collision is "new." Manifolds are not guaranteed to exist anymore.
     ea::unordered_map<ea::pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, ManifoldPair> previousCollisions_;
+    /// World transforms received from simulation during current step.
+    ea::vector<DelayedWorldTransform> pendingWorldTransforms_;
     /// Delayed (parented) world transform assignments.
     ea::unordered_map<RigidBody*, DelayedWorldTransform> delayedWorldTransforms_;
     /// Cache for trimesh geometry data by model and LOD level.
@@ -399,6 +468,8 @@ private:
     bool applyingTransforms_{};
     /// Simulating flag.
     bool simulating_{};
+    /// Whether the Bullet world is multithreaded.
+    bool multithreaded_{};
     /// Debug draw depth test mode.
     bool debugDepthTest_{};
     /// Debug renderer.
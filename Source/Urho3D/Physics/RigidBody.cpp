@@ -159,31 +159,14 @@ void RigidBody::setWorldTransform(const btTransform& worldTrans)
     if (!body_->isActive()) // Fix #2491
         return;
 
-    Quaternion newWorldRotation = ToQuaternion(worldTrans.getRotation());
-    Vector3 newWorldPosition = ToVector3(worldTrans.getOrigin()) - newWorldRotation * centerOfMass_;
-    RigidBody* parentRigidBody = nullptr;
-
     // It is possible that the RigidBody component has been kept alive via a shared pointer,
     // while its scene node has already been destroyed
-    if (node_)
+    if (node_ && physicsWorld_)
     {
-        // If the rigid body is parented to another rigid body, can not set the transform immediately.
-        // In that case store it to PhysicsWorld for delayed assignment
-        Node* parent = node_->GetParent();
-        if (parent != GetScene() && parent)
-            parentRigidBody = parent->GetComponent<RigidBody>();
-
-        if (!parentRigidBody)
-            ApplyWorldTransform(newWorldPosition, newWorldRotation);
-        else
-        {
-            DelayedWorldTransform delayed;
-            delayed.rigidBody_ = this;
-            delayed.parentRigidBody_ = parentRigidBody;
-            delayed.worldPosition_ = newWorldPosition;
-            delayed.worldRotation_ = newWorldRotation;
-            physicsWorld_->AddDelayedWorldTransform(delayed);
-        }
+        // Transform is applied to the node by PhysicsWorld together with other bodies after synchronization
+        const Quaternion newWorldRotation = ToQuaternion(worldTrans.getRotation());
+        const Vector3 newWorldPosition = ToVector3(worldTrans(ToBtVector3(-centerOfMass_)));
+        physicsWorld_->AddPendingWorldTransform(this, newWorldPosition, newWorldRotation);
     }
 
     hasSimulated_ = true;
@@ -683,8 +666,7 @@ void RigidBody::ApplyWorldTransform(const Vector3& newWorldPosition, const Quate
 
     physicsWorld_->SetApplyingTransforms(true);
 
-    node_->SetWorldPosition(newWorldPosition);
-    node_->SetWorldRotation(newWorldRotation);
+    node_->SetWorldTransform(newWorldPosition, newWorldRotation);
     lastPosition_ = node_->GetWorldPosition();
     lastRotation_ = node_->GetWorldRotation();
 
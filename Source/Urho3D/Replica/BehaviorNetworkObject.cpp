@@ -29,6 +29,45 @@
 namespace Urho3D
 {
 
+namespace
+{
+
+/// Serializer that forwards data to another serializer and counts written bytes.
+class CountingSerializer : public Serializer
+{
+public:
+    explicit CountingSerializer(Serializer& dest) : dest_(dest) {}
+
+    unsigned Write(const void* data, unsigned size) override
+    {
+        const unsigned numBytes = dest_.Write(data, size);
+        numBytes_ += numBytes;
+        return numBytes;
+    }
+
+    unsigned GetNumBytes() const { return numBytes_; }
+
+private:
+    Serializer& dest_;
+    unsigned numBytes_{};
+};
+
+template <class T>
+void WriteBehaviorData(NetworkComponentTrafficVector* breakdown, NetworkBehavior* behavior, Serializer& dest, T write)
+{
+    if (!breakdown)
+    {
+        write(dest);
+        return;
+    }
+
+    CountingSerializer countingDest(dest);
+    write(countingDest);
+    breakdown->push_back({behavior->GetType(), &behavior->GetTypeName(), countingDest.GetNumBytes()});
+}
+
+}
+
 NetworkBehavior::NetworkBehavior(Context* context, NetworkCallbackFlags callbackMask)
     : Component(context)
     , callbackMask_(callbackMask)
@@ -178,7 +217,11 @@ void BehaviorNetworkObject::WriteSnapshot(NetworkFrame frame, Serializer& dest)
 
     // Write actual behaviors data
     for (const auto& connectedBehavior : behaviors_)
-        connectedBehavior.component_->WriteSnapshot(frame, dest);
+    {
+        NetworkBehavior* behavior = connectedBehavior.component_;
+        WriteBehaviorData(trafficBreakdown_, behavior, dest,
+            [&](Serializer& behaviorDest) { behavior->WriteSnapshot(frame, behaviorDest); });
+    }
 }
 
 void BehaviorNetworkObject::InitializeFromSnapshot(NetworkFrame frame, Deserializer& src, bool isOwned)
@@ -291,7 +334,11 @@ void BehaviorNetworkObject::WriteReliableDelta(NetworkFrame frame, Serializer& d
         for (const auto& connectedBehavior : behaviors_)
         {
             if (reliableUpdateMask_ & connectedBehavior.bit_)
-                connectedBehavior.component_->WriteReliableDelta(frame, dest);
+            {
+                NetworkBehavior* behavior = connectedBehavior.component_;
+                WriteBehaviorData(trafficBreakdown_, behavior, dest,
+                    [&](Serializer& behaviorDest) { behavior->WriteReliableDelta(frame, behaviorDest); });
+            }
         }
     }
 }
@@ -342,7 +389,11 @@ void BehaviorNetworkObject::WriteUnreliableDelta(NetworkFrame frame, Serializer&
         for (const auto& connectedBehavior : behaviors_)
         {
             if (unreliableUpdateMask_ & connectedBehavior.bit_)
-                connectedBehavior.component_->WriteUnreliableDelta(frame, dest);
+            {
+                NetworkBehavior* behavior = connectedBehavior.component_;
+                WriteBehaviorData(trafficBreakdown_, behavior, dest,
+                    [&](Serializer& behaviorDest) { behavior->WriteUnreliableDelta(frame, behaviorDest); });
+            }
         }
     }
 }
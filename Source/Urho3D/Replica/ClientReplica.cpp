@@ -25,6 +25,7 @@
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Exception.h"
+#include "../IO/Compression.h"
 #include "../IO/Log.h"
 #include "../Network/Connection.h"
 #include "../Network/Network.h"
@@ -131,6 +132,7 @@ ClientReplica::ClientReplica(
     : ClientReplicaClock(scene, connection, initialClock, serverSettings)
     , network_(GetSubsystem<Network>())
     , objectRegistry_(scene->GetComponent<ReplicationManager>())
+    , deltaCompressionHistory_(GetSetting(NetworkSettings::DeltaCompressionHistory).GetUInt())
 {
     URHO3D_ASSERT(objectRegistry_);
 
@@ -238,13 +240,54 @@ void ClientReplica::ProcessRemoveObjects(MemoryBuffer& messageData)
 void ClientReplica::ProcessAddObjects(MemoryBuffer& messageData)
 {
     const auto messageFrame = static_cast<NetworkFrame>(messageData.ReadInt64());
-    while (!messageData.IsEof())
+    numPendingSnapshots_ = messageData.ReadVLE();
+
+    // Dictionary is append-only and is always received before snapshots compressed with it
+    const unsigned dictionaryAppendSize = messageData.ReadVLE();
+    if (dictionaryAppendSize > messageData.GetSize() - messageData.GetPosition()
+        || snapshotDictionary_.size() + dictionaryAppendSize > MaxCompressionDictionarySize)
     {
-        const auto networkId = static_cast<NetworkId>(messageData.ReadUInt());
-        const StringHash componentType = messageData.ReadStringHash();
-        const unsigned ownerConnectionId = messageData.ReadVLE();
+        URHO3D_LOGERROR("Invalid snapshot dictionary received");
+        return;
+    }
 
-        messageData.ReadBuffer(componentBuffer_.GetBuffer());
+    const unsigned dictionaryOffset = snapshotDictionary_.size();
+    snapshotDictionary_.resize(dictionaryOffset + dictionaryAppendSize);
+    messageData.Read(snapshotDictionary_.data() + dictionaryOffset, dictionaryAppendSize);
+
+    const unsigned rawSize = messageData.ReadVLE();
+    if (rawSize == 0)
+    {
+        ProcessSnapshots(messageFrame, messageData);
+        return;
+    }
+
+    const unsigned compressedSize = messageData.GetSize() - messageData.GetPosition();
+    snapshotBuffer_.resize(rawSize);
+    if (!DecompressDataWithDictionary(snapshotBuffer_.data(), rawSize, messageData.GetData() + messageData.GetPosition(),
+        compressedSize, snapshotDictionary_.data(), snapshotDictionary_.size()))
+    {
+        URHO3D_LOGERROR("Cannot decompress snapshots");
+        return;
+    }
+
+    MemoryBuffer snapshotData(snapshotBuffer_);
+    ProcessSnapshots(messageFrame, snapshotData);
+}
+
+void ClientReplica::ProcessSnapshots(NetworkFrame messageFrame, MemoryBuffer& snapshotData)
+{
+    while (!snapshotData.IsEof())
+    {
+        const auto networkId = static_cast<NetworkId>(snapshotData.ReadUInt());
+        const StringHash componentType = snapshotData.ReadStringHash();
+        const unsigned ownerConnectionId = snapshotData.ReadVLE();
+
+        snapshotData.ReadBuffer(componentBuffer_.GetBuffer());
+        ++numReceivedSnapshots_;
+
+        // Updates received before the snapshot cannot be used as baseline
+        receivedUnreliableUpdates_.erase(networkId);
 
         const bool isOwned = ownerConnectionId == GetConnectionId();
         if (NetworkObject* networkObject = CreateNetworkObject(networkId, componentType))
@@ -287,20 +330,106 @@ void ClientReplica::ProcessUpdateObjectsUnreliable(MemoryBuffer& messageData)
 {
     const auto messageFrame = static_cast<NetworkFrame>(messageData.ReadInt64());
 
+    bool isComplete = true;
     while (!messageData.IsEof())
     {
         const auto networkId = static_cast<NetworkId>(messageData.ReadUInt());
         const StringHash componentType = messageData.ReadStringHash();
 
+        if (!ReadUnreliableUpdate(networkId, messageFrame, messageData))
+        {
+            isComplete = false;
+            continue;
+        }
+
+        NetworkObject* networkObject = GetCheckedNetworkObject(networkId, componentType);
+        if (!networkObject)
+        {
+            // Don't let server use this frame as baseline, the update is not stored
+            isComplete = false;
+            continue;
+        }
+
+        StoreUnreliableUpdate(networkId, messageFrame);
+
+        componentBuffer_.Resize(componentBuffer_.GetBuffer().size());
+        componentBuffer_.Seek(0);
+        networkObject->ReadUnreliableDelta(messageFrame, componentBuffer_);
+    }
+
+    // Server may use only completely decoded frames as baseline
+    if (isComplete)
+        AcknowledgeFrame(messageFrame);
+}
+
+bool ClientReplica::ReadUnreliableUpdate(NetworkId networkId, NetworkFrame messageFrame, MemoryBuffer& messageData)
+{
+    const unsigned baselineDistance = messageData.ReadVLE();
+    if (baselineDistance == 0)
         messageData.ReadBuffer(componentBuffer_.GetBuffer());
+    else
+    {
+        messageData.ReadBuffer(deltaBuffer_);
 
-        if (NetworkObject* networkObject = GetCheckedNetworkObject(networkId, componentType))
+        const auto iter = receivedUnreliableUpdates_.find(networkId);
+        const NetworkFrame baselineFrame = messageFrame - baselineDistance;
+        const ReceivedUnreliableUpdate* baseline = iter != receivedUnreliableUpdates_.end()
+            ? &iter->second[GetFrameRingIndex(baselineFrame, deltaCompressionHistory_)]
+            : nullptr;
+
+        if (!baseline || baseline->frame_ != baselineFrame)
         {
-            componentBuffer_.Resize(componentBuffer_.GetBuffer().size());
-            componentBuffer_.Seek(0);
-            networkObject->ReadUnreliableDelta(messageFrame, componentBuffer_);
+            URHO3D_LOGWARNING("Cannot find baseline #{} for NetworkObject {}",
+                static_cast<long long>(baselineFrame), ToString(networkId));
+            return false;
+        }
+
+        if (!DecodeDeltaUpdate(baseline->data_, deltaBuffer_, componentBuffer_.GetBuffer()))
+        {
+            URHO3D_LOGWARNING("Cannot decode delta update for NetworkObject {}", ToString(networkId));
+            return false;
         }
     }
+    return true;
+}
+
+void ClientReplica::StoreUnreliableUpdate(NetworkId networkId, NetworkFrame messageFrame)
+{
+    if (deltaCompressionHistory_ == 0)
+        return;
+
+    auto& history = receivedUnreliableUpdates_[networkId];
+    history.resize(deltaCompressionHistory_);
+
+    ReceivedUnreliableUpdate& update = history[GetFrameRingIndex(messageFrame, deltaCompressionHistory_)];
+    update.frame_ = messageFrame;
+    update.data_ = componentBuffer_.GetBuffer();
+}
+
+void ClientReplica::AcknowledgeFrame(NetworkFrame frame)
+{
+    if (deltaCompressionHistory_ == 0)
+        return;
+
+    hasPendingAck_ = true;
+    if (!latestAcknowledgedFrame_)
+    {
+        latestAcknowledgedFrame_ = frame;
+        return;
+    }
+
+    const long long offset = static_cast<long long>(frame - *latestAcknowledgedFrame_);
+    if (offset > 0)
+    {
+        // Shift previous frames and mark the former latest frame
+        const unsigned maxOffset = MsgUpdateObjectsAck::MaxPreviousFrames;
+        previousAcknowledgedFramesMask_ = offset <= maxOffset
+            ? ((previousAcknowledgedFramesMask_ << 1) | 1u) << (offset - 1)
+            : 0u;
+        latestAcknowledgedFrame_ = frame;
+    }
+    else if (offset < 0 && offset >= -static_cast<long long>(MsgUpdateObjectsAck::MaxPreviousFrames))
+        previousAcknowledgedFramesMask_ |= 1u << (-offset - 1);
 }
 
 NetworkObject* ClientReplica::CreateNetworkObject(NetworkId networkId, StringHash componentType)
@@ -349,6 +478,8 @@ NetworkObject* ClientReplica::GetCheckedNetworkObject(NetworkId networkId, Strin
 
 void ClientReplica::RemoveNetworkObject(WeakPtr<NetworkObject> networkObject)
 {
+    receivedUnreliableUpdates_.erase(networkObject->GetNetworkId());
+
     if (networkObject->GetNetworkMode() == NetworkObjectMode::ClientOwned)
         ownedObjects_.erase(networkObject);
 
@@ -407,9 +538,26 @@ void ClientReplica::OnNetworkUpdate()
         network_->SendEvent(E_ENDCLIENTNETWORKFRAME);
 
         SendObjectsFeedbackUnreliable(GetInputTime().Frame());
+        SendUpdateObjectsAck();
+
+        if (NetworkStatistics* statistics = connection_->GetTrafficStatistics())
+            statistics->EndFrame(1.0f / GetUpdateFrequency());
     }
 }
 
+void ClientReplica::SendUpdateObjectsAck()
+{
+    if (!hasPendingAck_ || !latestAcknowledgedFrame_)
+        return;
+
+    hasPendingAck_ = false;
+
+    MsgUpdateObjectsAck msg;
+    msg.latestFrame_ = *latestAcknowledgedFrame_;
+    msg.previousFramesMask_ = previousAcknowledgedFramesMask_;
+    connection_->SendSerializedMessage(MSG_UPDATE_OBJECTS_ACK, msg, PT_UNRELIABLE_UNORDERED);
+}
+
 void ClientReplica::SendObjectsFeedbackUnreliable(NetworkFrame feedbackFrame)
 {
     connection_->SendGeneratedMessage(MSG_OBJECTS_FEEDBACK_UNRELIABLE, PT_UNRELIABLE_UNORDERED,
@@ -32,6 +32,7 @@
 #include "../Replica/ProtocolMessages.h"
 
 #include <EASTL/optional.h>
+#include <EASTL/unordered_map.h>
 #include <EASTL/unordered_set.h>
 #include <EASTL/bonus/ring_buffer.h>
 
@@ -136,11 +137,17 @@ public:
     const ea::unordered_set<WeakPtr<NetworkObject>>& GetOwnedNetworkObjects() const { return ownedObjects_; };
     bool HasOwnedNetworkObjects() const { return !ownedObjects_.empty(); }
     NetworkObject* GetOwnedNetworkObject() const { return ownedObjects_.size() == 1 ? *ownedObjects_.begin() : nullptr; }
+    /// Return number of NetworkObject-s that are relevant for this client but are not replicated yet
+    /// because of server bandwidth limits. May be used to report join progress.
+    unsigned GetNumPendingSnapshots() const { return numPendingSnapshots_; }
+    /// Return number of NetworkObject-s created from snapshots.
+    unsigned GetNumReceivedSnapshots() const { return numReceivedSnapshots_; }
 
 private:
     void OnInputReady(float timeStep);
     void OnNetworkUpdate();
     void SendObjectsFeedbackUnreliable(NetworkFrame feedbackFrame);
+    void SendUpdateObjectsAck();
 
     NetworkObject* CreateNetworkObject(NetworkId networkId, StringHash componentType);
     NetworkObject* GetCheckedNetworkObject(NetworkId networkId, StringHash componentType);
@@ -149,9 +156,22 @@ private:
     void ProcessSceneClock(const MsgSceneClock& msg);
     void ProcessRemoveObjects(MemoryBuffer& messageData);
     void ProcessAddObjects(MemoryBuffer& messageData);
+    void ProcessSnapshots(NetworkFrame messageFrame, MemoryBuffer& snapshotData);
     void ProcessUpdateObjectsReliable(MemoryBuffer& messageData);
     void ProcessUpdateObjectsUnreliable(MemoryBuffer& messageData);
 
+    /// Read unreliable update of the object, either raw or delta-encoded. Return false if baseline is not available.
+    bool ReadUnreliableUpdate(NetworkId networkId, NetworkFrame messageFrame, MemoryBuffer& messageData);
+    void StoreUnreliableUpdate(NetworkId networkId, NetworkFrame messageFrame);
+    void AcknowledgeFrame(NetworkFrame frame);
+
+    /// Unreliable update of the object that may be used as baseline for delta decoding.
+    struct ReceivedUnreliableUpdate
+    {
+        ea::optional<NetworkFrame> frame_;
+        ByteVector data_;
+    };
+
     const WeakPtr<Network> network_;
     const WeakPtr<NetworkObjectRegistry> objectRegistry_;
 
@@ -159,6 +179,24 @@ private:
     ea::unordered_set<WeakPtr<NetworkObject>> ownedObjects_;
 
     VectorBuffer componentBuffer_;
+
+    /// Snapshot compression state.
+    /// @{
+    ByteVector snapshotDictionary_;
+    ByteVector snapshotBuffer_;
+    unsigned numPendingSnapshots_{};
+    unsigned numReceivedSnapshots_{};
+    /// @}
+
+    /// Delta compression state.
+    /// @{
+    const unsigned deltaCompressionHistory_{};
+    ea::unordered_map<NetworkId, ea::vector<ReceivedUnreliableUpdate>> receivedUnreliableUpdates_;
+    ea::optional<NetworkFrame> latestAcknowledgedFrame_;
+    unsigned previousAcknowledgedFramesMask_{};
+    bool hasPendingAck_{};
+    ByteVector deltaBuffer_;
+    /// @}
 };
 
 }
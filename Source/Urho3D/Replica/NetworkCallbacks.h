@@ -69,6 +69,11 @@ URHO3D_FLAGSET(NetworkCallbackMask, NetworkCallbackFlags);
 
 /// Server-side callbacks for NetworkObject and NetworkBehavior.
 /// ServerReplicator is guaranteed to be present.
+///
+/// WriteSnapshot, Prepare*Delta and Write*Delta are called from WorkQueue threads,
+/// concurrently for different NetworkObject-s but never concurrently for the same NetworkObject.
+/// Implementations should only modify state of their own NetworkObject and may only read the rest of the scene.
+/// All built-in behaviors follow this rule.
 class ServerNetworkCallback
 {
 public:
@@ -81,4 +81,11 @@ inline NetworkFrame operator-(NetworkFrame lhs, long long rhs)
     return static_cast<NetworkFrame>(static_cast<long long>(lhs) - rhs);
 }
 
+/// Return index of the frame in the ring buffer of specified size.
+inline unsigned GetFrameRingIndex(NetworkFrame frame, unsigned size)
+{
+    const long long index = static_cast<long long>(frame) % static_cast<long long>(size);
+    return static_cast<unsigned>(index >= 0 ? index : index + size);
+}
+
 } // namespace Urho3D
@@ -51,6 +51,8 @@ void NetworkObject::SetOwner(AbstractConnection* owner)
 void NetworkObject::RegisterObject(Context* context)
 {
     context->AddAbstractReflection<NetworkObject>(Category_Network);
+
+    URHO3D_ATTRIBUTE("Update Priority", float, updatePriority_, DefaultUpdatePriority, AM_DEFAULT);
 }
 
 void NetworkObject::UpdateObjectHierarchy()
@@ -67,11 +67,19 @@ class URHO3D_API NetworkObject
     URHO3D_OBJECT(NetworkObject, ReferencedComponentBase);
 
 public:
+    static constexpr float DefaultUpdatePriority = 1.0f;
+
     explicit NetworkObject(Context* context);
     ~NetworkObject() override;
 
     /// Server-only: set owner connection which is allowed to send feedback for this object.
     void SetOwner(AbstractConnection* owner);
+    /// Server-only: set importance of unreliable updates when bandwidth is limited.
+    void SetUpdatePriority(float priority) { updatePriority_ = priority; }
+    float GetUpdatePriority() const { return updatePriority_; }
+    /// Server-only: set container that receives sizes of component data written by the object.
+    /// Used for traffic statistics, may be null.
+    void SetTrafficBreakdown(NetworkComponentTrafficVector* breakdown) { trafficBreakdown_ = breakdown; }
 
     static void RegisterObject(Context* context);
 
@@ -116,6 +124,9 @@ protected:
     NetworkObject* GetOtherNetworkObject(NetworkId networkId) const;
     void SetParentNetworkObject(NetworkId parentNetworkId);
 
+    /// Container for traffic statistics, if enabled.
+    NetworkComponentTrafficVector* trafficBreakdown_{};
+
 private:
     NetworkObject* FindParentNetworkObject() const;
     void AddChildNetworkObject(NetworkObject* networkObject);
@@ -124,6 +135,7 @@ private:
     /// ReplicationManager corresponding to the NetworkObject.
     NetworkObjectMode networkMode_{};
     WeakPtr<AbstractConnection> ownerConnection_{};
+    float updatePriority_{DefaultUpdatePriority};
 
     /// NetworkObject hierarchy
     /// @{
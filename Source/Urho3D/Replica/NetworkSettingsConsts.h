@@ -64,7 +64,7 @@ namespace NetworkSettings
 /// @{
 
 /// Version of internal protocol.
-URHO3D_NETWORK_SETTING(InternalProtocolVersion, unsigned, 1);
+URHO3D_NETWORK_SETTING(InternalProtocolVersion, unsigned, 2);
 /// Update frequency of the server, frames per second.
 URHO3D_NETWORK_SETTING(UpdateFrequency, unsigned, 30);
 /// Connection ID of current client.
@@ -81,6 +81,9 @@ URHO3D_NETWORK_SETTING(InterpolationLimit, float, 0.25f);
 URHO3D_NETWORK_SETTING(MaxInputFrames, unsigned, 256);
 /// Maximum number of input frames sent to server including relevant frame.
 URHO3D_NETWORK_SETTING(MaxInputRedundancy, unsigned, 32);
+/// Number of recent frames that can be used as baseline for delta compression of unreliable updates.
+/// Zero disables delta compression.
+URHO3D_NETWORK_SETTING(DeltaCompressionHistory, unsigned, 16);
 
 /// @}
 
@@ -103,6 +106,23 @@ URHO3D_NETWORK_SETTING(InputBufferingMin, unsigned, 0);
 URHO3D_NETWORK_SETTING(InputBufferingMax, unsigned, 8);
 /// Interval in seconds between NetworkObject becoming unneeded for client and replication stopped.
 URHO3D_NETWORK_SETTING(RelevanceTimeout, float, 5.0f);
+/// Cell size of spatial index used for interest management. Zero disables interest management.
+/// NetworkObject-s outside of interest area of the client are checked for relevance only on timeout or when they enter or leave the area.
+URHO3D_NETWORK_SETTING(InterestCellSize, float, 0.0f);
+/// Radius of interest area around each NetworkObject owned by the client.
+/// Should be no less than the distance of FilteredByDistance behaviors.
+URHO3D_NETWORK_SETTING(InterestRadius, float, 100.0f);
+/// Max size in bytes of unreliable update message sent to the client per network frame. Zero means no limit.
+/// If limited, NetworkObject-s are sent in order of priority accumulated over time, at least one object is always sent.
+URHO3D_NETWORK_SETTING(UnreliableUpdateBudget, unsigned, 0);
+/// Whether to compress snapshots of NetworkObject-s sent to the client when replication begins.
+URHO3D_NETWORK_SETTING(SnapshotCompression, bool, true);
+/// Max size in bytes of the dictionary used for snapshot compression. Zero disables the dictionary.
+/// Dictionary is built from snapshots of different kinds of NetworkObject-s and is sent to each client once.
+URHO3D_NETWORK_SETTING(SnapshotDictionarySize, unsigned, 16 * 1024);
+/// Max estimated size in bytes of snapshots sent to the client per network frame. Zero means no limit.
+/// If limited, replication of new NetworkObject-s is spread over multiple frames, at least one object is always sent.
+URHO3D_NETWORK_SETTING(SnapshotBudget, unsigned, 0);
 /// Duration in seconds of value tracking on server. Used for lag compensation.
 URHO3D_NETWORK_SETTING(ServerTracingDuration, float, 5.0f);
 
@@ -27,6 +27,7 @@
 #ifdef URHO3D_PHYSICS
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
+#include "../IO/BitStream.h"
 #include "../Physics/KinematicCharacterController.h"
 #include "../Physics/PhysicsEvents.h"
 #include "../Physics/PhysicsWorld.h"
@@ -39,6 +40,17 @@
 namespace Urho3D
 {
 
+namespace
+{
+
+Vector3 QuantizeAndRestore(const Vector3& value, float range, unsigned numBits)
+{
+    const auto restore = [&](float x) { return DequantizeFloat(QuantizeFloat(x, range, numBits), range, numBits); };
+    return {restore(value.x_), restore(value.y_), restore(value.z_)};
+}
+
+}
+
 PredictedKinematicController::PredictedKinematicController(Context* context)
     : NetworkBehavior(context, CallbackMask)
 {
@@ -51,6 +63,13 @@ PredictedKinematicController::~PredictedKinematicController()
 void PredictedKinematicController::RegisterObject(Context* context)
 {
     context->AddFactoryReflection<PredictedKinematicController>(Category_Network);
+
+    URHO3D_COPY_BASE_ATTRIBUTES(NetworkBehavior);
+
+    URHO3D_ATTRIBUTE("Quantize Input", bool, quantizeInput_, DefaultQuantizeInput, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Walk Velocity Range", float, walkVelocityRange_, DefaultWalkVelocityRange, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Walk Velocity Bits", unsigned, walkVelocityBits_, DefaultWalkVelocityBits, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Rotation Bits", unsigned, rotationBits_, DefaultRotationBits, AM_DEFAULT);
 }
 
 void PredictedKinematicController::SetWalkVelocity(const Vector3& velocity)
@@ -61,10 +80,20 @@ void PredictedKinematicController::SetWalkVelocity(const Vector3& velocity)
     NetworkObject* networkObject = GetNetworkObject();
     URHO3D_ASSERT(networkObject);
 
-    if (networkObject->IsStandalone() || networkObject->IsOwnedByThisClient())
+    if (networkObject->IsStandalone())
     {
         client_.walkVelocity_ = velocity;
     }
+    else if (networkObject->IsOwnedByThisClient())
+    {
+        // Server will receive quantized velocity, so use the same value for prediction
+        if (quantizeInput_)
+        {
+            client_.walkVelocity_ = QuantizeAndRestore(velocity, walkVelocityRange_, walkVelocityBits_);
+        }
+        else
+            client_.walkVelocity_ = velocity;
+    }
     else
     {
         URHO3D_LOGWARNING(
@@ -127,8 +156,27 @@ void PredictedKinematicController::InitializeOnServer()
     });
 }
 
+void PredictedKinematicController::WriteSnapshot(NetworkFrame frame, Serializer& dest)
+{
+    dest.WriteBool(quantizeInput_);
+    if (quantizeInput_)
+    {
+        dest.WriteFloat(walkVelocityRange_);
+        dest.WriteVLE(walkVelocityBits_);
+        dest.WriteVLE(rotationBits_);
+    }
+}
+
 void PredictedKinematicController::InitializeFromSnapshot(NetworkFrame frame, Deserializer& src, bool isOwned)
 {
+    quantizeInput_ = src.ReadBool();
+    if (quantizeInput_)
+    {
+        walkVelocityRange_ = src.ReadFloat();
+        walkVelocityBits_ = src.ReadVLE();
+        rotationBits_ = src.ReadVLE();
+    }
+
     InitializeCommon();
     if (!IsConnectedToComponents())
         return;
@@ -181,6 +229,10 @@ void PredictedKinematicController::InitializeCommon()
 
     previousPosition_ = node_->GetWorldPosition();
 
+    walkVelocityRange_ = ea::max(walkVelocityRange_, M_EPSILON);
+    walkVelocityBits_ = Clamp(walkVelocityBits_, 2u, BitWriter::MaxQuantizationBits);
+    rotationBits_ = Clamp(rotationBits_, 2u, BitWriter::MaxQuantizationBits);
+
     if (Scene* scene = node_->GetScene())
     {
         physicsWorld_ = scene->GetComponent<PhysicsWorld>();
@@ -214,15 +266,33 @@ void PredictedKinematicController::WriteUnreliableFeedback(NetworkFrame frame, S
     const unsigned inputBufferSize = ea::min({client_.desiredRedundancy_, maxRedundancy_, maxSize});
 
     dest.WriteVLE(inputBufferSize);
-    ea::for_each_n(client_.input_.rbegin(), inputBufferSize,
-        [&](const InputFrame& inputFrame) { WriteInputFrame(inputFrame, dest); });
+    if (quantizeInput_)
+    {
+        BitWriter bits{dest};
+        ea::for_each_n(client_.input_.rbegin(), inputBufferSize,
+            [&](const InputFrame& inputFrame) { WriteQuantizedInputFrame(inputFrame, bits); });
+    }
+    else
+    {
+        ea::for_each_n(client_.input_.rbegin(), inputBufferSize,
+            [&](const InputFrame& inputFrame) { WriteInputFrame(inputFrame, dest); });
+    }
 }
 
 void PredictedKinematicController::ReadUnreliableFeedback(NetworkFrame feedbackFrame, Deserializer& src)
 {
     const unsigned numInputFrames = ea::min(src.ReadVLE(), maxRedundancy_);
-    for (unsigned i = 0; i < numInputFrames; ++i)
-        ReadInputFrame(feedbackFrame - i, src);
+    if (quantizeInput_)
+    {
+        BitReader bits{src};
+        for (unsigned i = 0; i < numInputFrames; ++i)
+            ReadQuantizedInputFrame(feedbackFrame - i, bits);
+    }
+    else
+    {
+        for (unsigned i = 0; i < numInputFrames; ++i)
+            ReadInputFrame(feedbackFrame - i, src);
+    }
 }
 
 void PredictedKinematicController::OnServerFrameBegin(NetworkFrame serverFrame)
@@ -388,9 +458,30 @@ void PredictedKinematicController::ReadInputFrame(NetworkFrame frame, Deserializ
     inputFrame.walkVelocity_ = walkVelocity;
     inputFrame.needJump_ = needJump;
     inputFrame.rotation_ = rotation;
+    AddInputFrameOnServer(inputFrame);
+}
+
+void PredictedKinematicController::WriteQuantizedInputFrame(const InputFrame& inputFrame, BitWriter& dest) const
+{
+    dest.WriteQuantizedVelocity(inputFrame.walkVelocity_, walkVelocityRange_, walkVelocityBits_);
+    dest.WriteBool(inputFrame.needJump_);
+    dest.WriteSmallestThreeQuaternion(inputFrame.rotation_, rotationBits_);
+}
 
-    if (!server_.input_.Has(frame))
-        server_.input_.Set(frame, inputFrame);
+void PredictedKinematicController::ReadQuantizedInputFrame(NetworkFrame frame, BitReader& src)
+{
+    InputFrame inputFrame;
+    inputFrame.frame_ = frame;
+    inputFrame.walkVelocity_ = src.ReadQuantizedVelocity(walkVelocityRange_, walkVelocityBits_);
+    inputFrame.needJump_ = src.ReadBool();
+    inputFrame.rotation_ = src.ReadSmallestThreeQuaternion(rotationBits_);
+    AddInputFrameOnServer(inputFrame);
+}
+
+void PredictedKinematicController::AddInputFrameOnServer(const InputFrame& inputFrame)
+{
+    if (!server_.input_.Has(inputFrame.frame_))
+        server_.input_.Set(inputFrame.frame_, inputFrame);
 }
 
 }
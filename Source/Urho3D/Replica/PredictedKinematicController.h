@@ -35,6 +35,8 @@
 namespace Urho3D
 {
 
+class BitReader;
+class BitWriter;
 class KinematicCharacterController;
 class ReplicatedTransform;
 
@@ -45,6 +47,10 @@ class URHO3D_API PredictedKinematicController : public NetworkBehavior
 
 public:
     static constexpr NetworkCallbackFlags CallbackMask = NetworkCallbackMask::UnreliableFeedback | NetworkCallbackMask::InterpolateState;
+    static constexpr bool DefaultQuantizeInput = false;
+    static constexpr float DefaultWalkVelocityRange = 16.0f;
+    static constexpr unsigned DefaultWalkVelocityBits = 12;
+    static constexpr unsigned DefaultRotationBits = 12;
 
     explicit PredictedKinematicController(Context* context);
     ~PredictedKinematicController() override;
@@ -55,6 +61,18 @@ public:
     void SetWalkVelocity(const Vector3& velocity);
     /// Set whether to jump on the next update. Automatically reset on jump.
     void SetJump();
+
+    /// Quantization of client input. Walk velocity is quantized on the client too to keep prediction consistent.
+    /// @{
+    void SetQuantizeInput(bool value) { quantizeInput_ = value; }
+    bool GetQuantizeInput() const { return quantizeInput_; }
+    void SetWalkVelocityRange(float value) { walkVelocityRange_ = value; }
+    float GetWalkVelocityRange() const { return walkVelocityRange_; }
+    void SetWalkVelocityBits(unsigned value) { walkVelocityBits_ = value; }
+    unsigned GetWalkVelocityBits() const { return walkVelocityBits_; }
+    void SetRotationBits(unsigned value) { rotationBits_ = value; }
+    unsigned GetRotationBits() const { return rotationBits_; }
+    /// @}
     /// Return whether the behavior is properly connected to components.
     bool IsConnectedToComponents() const { return physicsWorld_ && replicatedTransform_ && kinematicController_; }
     bool IsConnectedToStandaloneComponents() const { return physicsWorld_ && kinematicController_; }
@@ -69,6 +87,7 @@ public:
     /// @{
     void InitializeStandalone() override;
     void InitializeOnServer() override;
+    void WriteSnapshot(NetworkFrame frame, Serializer& dest) override;
     void InitializeFromSnapshot(NetworkFrame frame, Deserializer& src, bool isOwned) override;
 
     void InterpolateState(float replicaTimeStep, float inputTimeStep, const NetworkTime& replicaTime, const NetworkTime& inputTime) override;
@@ -102,6 +121,17 @@ private:
 
     void WriteInputFrame(const InputFrame& inputFrame, Serializer& dest) const;
     void ReadInputFrame(NetworkFrame frame, Deserializer& src);
+    void WriteQuantizedInputFrame(const InputFrame& inputFrame, BitWriter& dest) const;
+    void ReadQuantizedInputFrame(NetworkFrame frame, BitReader& src);
+    void AddInputFrameOnServer(const InputFrame& inputFrame);
+
+    /// Attributes matching on the client and the server.
+    /// @{
+    bool quantizeInput_{DefaultQuantizeInput};
+    float walkVelocityRange_{DefaultWalkVelocityRange};
+    unsigned walkVelocityBits_{DefaultWalkVelocityBits};
+    unsigned rotationBits_{DefaultRotationBits};
+    /// @}
 
     WeakPtr<ReplicatedTransform> replicatedTransform_;
     WeakPtr<KinematicCharacterController> kinematicController_;
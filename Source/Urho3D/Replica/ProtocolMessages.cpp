@@ -82,4 +82,89 @@ ea::string MsgSceneClock::ToString() const
     return Format("{{latestFrame={} at {}, inputDelay={}}}", latestFrame_, latestFrameTime_, inputDelay_);
 }
 
+void MsgUpdateObjectsAck::Save(VectorBuffer& dest) const
+{
+    dest.WriteInt64(static_cast<long long>(latestFrame_));
+    dest.WriteUInt(previousFramesMask_);
+}
+
+void MsgUpdateObjectsAck::Load(MemoryBuffer& src)
+{
+    latestFrame_ = static_cast<NetworkFrame>(src.ReadInt64());
+    previousFramesMask_ = src.ReadUInt();
+}
+
+ea::string MsgUpdateObjectsAck::ToString() const
+{
+    return Format("{{latestFrame={}, previousFrames={:032b}}}", latestFrame_, previousFramesMask_);
+}
+
+void EncodeDeltaUpdate(ConstByteSpan baseline, ConstByteSpan data, VectorBuffer& dest)
+{
+    const auto getDelta = [&](unsigned i) -> unsigned char
+    { return i < baseline.size() ? data[i] ^ baseline[i] : data[i]; };
+
+    const unsigned size = data.size();
+    dest.WriteVLE(size);
+    dest.WriteVLE(baseline.size());
+
+    // Write pairs of unchanged and changed runs. Trailing unchanged run is implied by the end of data.
+    unsigned offset = 0;
+    while (offset < size)
+    {
+        const unsigned unchangedBegin = offset;
+        while (offset < size && getDelta(offset) == 0)
+            ++offset;
+        if (offset == size)
+            break;
+        const unsigned changedBegin = offset;
+        while (offset < size && getDelta(offset) != 0)
+            ++offset;
+
+        dest.WriteVLE(changedBegin - unchangedBegin);
+        dest.WriteVLE(offset - changedBegin);
+        for (unsigned i = changedBegin; i < offset; ++i)
+            dest.WriteUByte(getDelta(i));
+    }
+}
+
+bool DecodeDeltaUpdate(ConstByteSpan baseline, ConstByteSpan delta, ByteVector& result)
+{
+    MemoryBuffer src{delta.data(), static_cast<unsigned>(delta.size())};
+
+    const unsigned size = src.ReadVLE();
+    if (size > M_MAX_UNSIGNED / 2)
+        return false;
+
+    // Delta is meaningless if applied to another baseline
+    const unsigned expectedBaselineSize = src.ReadVLE();
+    if (expectedBaselineSize != baseline.size())
+        return false;
+
+    result.resize(size);
+    const unsigned baselineSize = ea::min<unsigned>(size, baseline.size());
+    ea::copy_n(baseline.data(), baselineSize, result.data());
+    ea::fill(result.begin() + baselineSize, result.end(), 0);
+
+    unsigned offset = 0;
+    while (offset < size && !src.IsEof())
+    {
+        const unsigned numUnchanged = src.ReadVLE();
+        const unsigned numChanged = src.ReadVLE();
+        if (numUnchanged > size - offset || numChanged > size - offset - numUnchanged)
+            return false;
+        if (numChanged > src.GetSize() - src.Tell())
+            return false;
+
+        offset += numUnchanged;
+        // Only the trailing unchanged run may be omitted, so every written run has changes
+        if (numChanged == 0)
+            return false;
+        for (unsigned i = 0; i < numChanged; ++i)
+            result[offset++] ^= src.ReadUByte();
+    }
+
+    return src.IsEof();
+}
+
 }
@@ -68,4 +68,24 @@ struct MsgSceneClock
     ea::string ToString() const;
 };
 
+struct MsgUpdateObjectsAck
+{
+    static constexpr unsigned MaxPreviousFrames = 32;
+
+    /// Latest frame of delivered unreliable update.
+    NetworkFrame latestFrame_{};
+    /// Bit #i is set if update for frame `latestFrame_ - i - 1` is delivered.
+    unsigned previousFramesMask_{};
+
+    void Save(VectorBuffer& dest) const;
+    void Load(MemoryBuffer& src);
+    ea::string ToString() const;
+};
+
+/// Encode data as byte-wise XOR delta against baseline. Runs of unchanged bytes are skipped.
+/// Baseline size is stored so that delta is rejected when decoded against another baseline.
+URHO3D_API void EncodeDeltaUpdate(ConstByteSpan baseline, ConstByteSpan data, VectorBuffer& dest);
+/// Decode data encoded by EncodeDeltaUpdate. Return false if data is malformed.
+URHO3D_API bool DecodeDeltaUpdate(ConstByteSpan baseline, ConstByteSpan delta, ByteVector& result);
+
 }
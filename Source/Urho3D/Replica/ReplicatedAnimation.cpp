@@ -25,6 +25,7 @@
 #include "../Core/Context.h"
 #include "../Graphics/Animation.h"
 #include "../Graphics/AnimationController.h"
+#include "../IO/BitStream.h"
 #include "../Network/NetworkEvents.h"
 #include "../Replica/ReplicatedAnimation.h"
 #include "../Resource/ResourceCache.h"
@@ -50,6 +51,8 @@ void ReplicatedAnimation::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE("Num Upload Attempts", unsigned, numUploadAttempts_, DefaultNumUploadAttempts, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Replicate Owner", bool, replicateOwner_, false, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Smoothing Time", float, smoothingTime_, DefaultSmoothingTime, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Quantize", bool, quantize_, DefaultQuantize, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Parameter Bits", unsigned, parameterBits_, DefaultParameterBits, AM_DEFAULT);
 }
 
 void ReplicatedAnimation::InitializeStandalone()
@@ -79,6 +82,10 @@ void ReplicatedAnimation::InitializeOnServer()
 
 void ReplicatedAnimation::WriteSnapshot(NetworkFrame frame, Serializer& dest)
 {
+    dest.WriteBool(quantize_);
+    if (quantize_)
+        dest.WriteVLE(parameterBits_);
+
     dest.WriteVLE(animationLookup_.size());
     for (const auto& [nameHash, name] : animationLookup_)
         dest.WriteString(name);
@@ -88,6 +95,10 @@ void ReplicatedAnimation::WriteSnapshot(NetworkFrame frame, Serializer& dest)
 
 void ReplicatedAnimation::InitializeFromSnapshot(NetworkFrame frame, Deserializer& src, bool isOwned)
 {
+    quantize_ = src.ReadBool();
+    if (quantize_)
+        parameterBits_ = src.ReadVLE();
+
     InitializeCommon();
     if (!animationController_)
         return;
@@ -108,6 +119,8 @@ void ReplicatedAnimation::InitializeFromSnapshot(NetworkFrame frame, Deserialize
 
 void ReplicatedAnimation::InitializeCommon()
 {
+    parameterBits_ = Clamp(parameterBits_, 2u, BitWriter::MaxQuantizationBits);
+
     animationController_ = GetComponent<AnimationController>();
     if (!animationController_)
         return;
@@ -180,7 +193,7 @@ void ReplicatedAnimation::WriteSnapshot(Serializer& dest)
     {
         const AnimationParameters& params = animationController_->GetAnimationParameters(i);
         server_.snapshotBuffer_.WriteStringHash(params.animationName_);
-        params.Serialize(server_.snapshotBuffer_);
+        params.Serialize(server_.snapshotBuffer_, GetQuantizationBits());
     }
 
     dest.WriteBuffer(server_.snapshotBuffer_.GetBuffer());
@@ -202,7 +215,7 @@ void ReplicatedAnimation::DecodeSnapshot(const AnimationSnapshot& snapshot, ea::
     while (!src.IsEof())
     {
         Animation* animation = GetAnimationByHash(src.ReadStringHash());
-        const auto params = AnimationParameters::Deserialize(animation, src);
+        const auto params = AnimationParameters::Deserialize(animation, src, GetQuantizationBits());
         if (animation)
             result.push_back(params);
     }
@@ -45,6 +45,8 @@ public:
     static constexpr unsigned SmallSnapshotSize = 256;
     static constexpr unsigned DefaultNumUploadAttempts = 4;
     static constexpr float DefaultSmoothingTime = 0.2f;
+    static constexpr bool DefaultQuantize = false;
+    static constexpr unsigned DefaultParameterBits = 12;
 
     static constexpr NetworkCallbackFlags CallbackMask =
         NetworkCallbackMask::ReliableDelta | NetworkCallbackMask::UnreliableDelta | NetworkCallbackMask::InterpolateState | NetworkCallbackMask::Update;
@@ -60,6 +62,10 @@ public:
     bool GetReplicateOwner() const { return replicateOwner_; }
     void SetSmoothingTime(float value) { smoothingTime_ = value; }
     float GetSmoothingTime() const { return smoothingTime_; }
+    void SetQuantize(bool value) { quantize_ = value; }
+    bool GetQuantize() const { return quantize_; }
+    void SetParameterBits(unsigned value) { parameterBits_ = value; }
+    unsigned GetParameterBits() const { return parameterBits_; }
 
     const StringMap& GetAnimationLookup() const { return animationLookup_; }
 
@@ -94,6 +100,7 @@ private:
     void WriteSnapshot(Serializer& dest);
     AnimationSnapshot ReadSnapshot(Deserializer& src) const;
     void DecodeSnapshot(const AnimationSnapshot& snapshot, ea::vector<AnimationParameters>& result) const;
+    unsigned GetQuantizationBits() const { return quantize_ ? parameterBits_ : 0; }
 
     WeakPtr<AnimationController> animationController_;
 
@@ -104,6 +111,13 @@ private:
     float smoothingTime_{DefaultSmoothingTime};
     /// @}
 
+    /// Attributes matching on the client and the server.
+    /// Animation time and weights are quantized if enabled.
+    /// @{
+    bool quantize_{DefaultQuantize};
+    unsigned parameterBits_{DefaultParameterBits};
+    /// @}
+
     StringMap animationLookup_;
 
     struct ServerData
@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../IO/BitStream.h"
 #include "../Network/NetworkEvents.h"
 #include "../Replica/ReplicatedTransform.h"
 #include "../Replica/NetworkSettingsConsts.h"
@@ -39,6 +40,16 @@ const StringVector replicatedRotationModeNames = {
     //"Y"
 };
 
+unsigned ClampQuantizationBits(unsigned numBits)
+{
+    return Clamp(numBits, 2u, BitWriter::MaxQuantizationBits);
+}
+
+float ClampQuantizationRange(float range)
+{
+    return ea::max(range, M_EPSILON);
+}
+
 }
 
 ReplicatedTransform::ReplicatedTransform(Context* context)
@@ -68,6 +79,14 @@ void ReplicatedTransform::RegisterObject(Context* context)
     URHO3D_ENUM_ATTRIBUTE("Synchronize Rotation", synchronizeRotation_, replicatedRotationModeNames, DefaultSynchronizeRotation, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Extrapolate Position", bool, extrapolatePosition_, DefaultExtrapolatePosition, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Extrapolate Rotation", bool, extrapolateRotation_, DefaultExtrapolateRotation, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Quantize", bool, quantize_, DefaultQuantize, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Position Range", float, positionRange_, DefaultPositionRange, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Position Bits", unsigned, positionBits_, DefaultPositionBits, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Velocity Range", float, velocityRange_, DefaultVelocityRange, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Velocity Bits", unsigned, velocityBits_, DefaultVelocityBits, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Rotation Bits", unsigned, rotationBits_, DefaultRotationBits, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Angular Velocity Range", float, angularVelocityRange_, DefaultAngularVelocityRange, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Angular Velocity Bits", unsigned, angularVelocityBits_, DefaultAngularVelocityBits, AM_DEFAULT);
 }
 
 void ReplicatedTransform::InitializeOnServer()
@@ -95,18 +114,42 @@ void ReplicatedTransform::WriteSnapshot(NetworkFrame frame, Serializer& dest)
     flags[1] = synchronizeRotation_ != ReplicatedRotationMode::None;
     flags[2] = extrapolatePosition_;
     flags[3] = extrapolateRotation_;
+    flags[4] = quantize_;
     dest.WriteVLE(flags.to_uint32());
+
+    if (quantize_)
+    {
+        dest.WriteFloat(positionRange_);
+        dest.WriteVLE(positionBits_);
+        dest.WriteFloat(velocityRange_);
+        dest.WriteVLE(velocityBits_);
+        dest.WriteVLE(rotationBits_);
+        dest.WriteFloat(angularVelocityRange_);
+        dest.WriteVLE(angularVelocityBits_);
+    }
 }
 
 void ReplicatedTransform::InitializeFromSnapshot(NetworkFrame frame, Deserializer& src, bool isOwned)
 {
-    InitializeCommon();
-
     ea::bitset<32> flags = src.ReadVLE();
     synchronizePosition_ = flags[0];
     synchronizeRotation_ = flags[1] ? ReplicatedRotationMode::XYZ : ReplicatedRotationMode::None;
     extrapolatePosition_ = flags[2];
     extrapolateRotation_ = flags[3];
+    quantize_ = flags[4];
+
+    if (quantize_)
+    {
+        positionRange_ = src.ReadFloat();
+        positionBits_ = src.ReadVLE();
+        velocityRange_ = src.ReadFloat();
+        velocityBits_ = src.ReadVLE();
+        rotationBits_ = src.ReadVLE();
+        angularVelocityRange_ = src.ReadFloat();
+        angularVelocityBits_ = src.ReadVLE();
+    }
+
+    InitializeCommon();
 
     const auto replicationManager = GetNetworkObject()->GetReplicationManager();
     const unsigned updateFrequency = replicationManager->GetUpdateFrequency();
@@ -128,6 +171,14 @@ void ReplicatedTransform::InitializeCommon()
 
     positionTrace_.Resize(traceDuration);
     rotationTrace_.Resize(traceDuration);
+
+    positionRange_ = ClampQuantizationRange(positionRange_);
+    positionBits_ = ClampQuantizationBits(positionBits_);
+    velocityRange_ = ClampQuantizationRange(velocityRange_);
+    velocityBits_ = ClampQuantizationBits(velocityBits_);
+    rotationBits_ = ClampQuantizationBits(rotationBits_);
+    angularVelocityRange_ = ClampQuantizationRange(angularVelocityRange_);
+    angularVelocityBits_ = ClampQuantizationBits(angularVelocityBits_);
 }
 
 void ReplicatedTransform::OnServerFrameEnd(NetworkFrame frame)
@@ -196,6 +247,12 @@ bool ReplicatedTransform::PrepareUnreliableDelta(NetworkFrame frame)
 
 void ReplicatedTransform::WriteUnreliableDelta(NetworkFrame frame, Serializer& dest)
 {
+    if (quantize_)
+    {
+        WriteQuantizedDelta(dest);
+        return;
+    }
+
     if (synchronizePosition_)
     {
         dest.WriteVector3(server_.position_);
@@ -211,6 +268,12 @@ void ReplicatedTransform::WriteUnreliableDelta(NetworkFrame frame, Serializer& d
 
 void ReplicatedTransform::ReadUnreliableDelta(NetworkFrame frame, Deserializer& src)
 {
+    if (quantize_)
+    {
+        ReadQuantizedDelta(frame, src);
+        return;
+    }
+
     if (synchronizePosition_)
     {
         const Vector3 position = src.ReadVector3();
@@ -228,6 +291,44 @@ void ReplicatedTransform::ReadUnreliableDelta(NetworkFrame frame, Deserializer&
     }
 }
 
+void ReplicatedTransform::WriteQuantizedDelta(Serializer& dest) const
+{
+    BitWriter bits{dest};
+
+    if (synchronizePosition_)
+    {
+        bits.WriteQuantizedVector3(server_.position_, positionRange_, positionBits_);
+        bits.WriteQuantizedVelocity(server_.velocity_, velocityRange_, velocityBits_);
+    }
+
+    if (synchronizeRotation_ == ReplicatedRotationMode::XYZ)
+    {
+        bits.WriteSmallestThreeQuaternion(server_.rotation_, rotationBits_);
+        bits.WriteQuantizedVelocity(server_.angularVelocity_, angularVelocityRange_, angularVelocityBits_);
+    }
+}
+
+void ReplicatedTransform::ReadQuantizedDelta(NetworkFrame frame, Deserializer& src)
+{
+    BitReader bits{src};
+
+    if (synchronizePosition_)
+    {
+        const Vector3 position = bits.ReadQuantizedVector3(positionRange_, positionBits_);
+        const Vector3 velocity = bits.ReadQuantizedVelocity(velocityRange_, velocityBits_);
+
+        positionTrace_.Set(frame, {position, velocity});
+    }
+
+    if (synchronizeRotation_ == ReplicatedRotationMode::XYZ)
+    {
+        const Quaternion rotation = bits.ReadSmallestThreeQuaternion(rotationBits_);
+        const Vector3 angularVelocity = bits.ReadQuantizedVelocity(angularVelocityRange_, angularVelocityBits_);
+
+        rotationTrace_.Set(frame, {rotation, angularVelocity});
+    }
+}
+
 PositionAndVelocity ReplicatedTransform::SampleTemporalPosition(const NetworkTime& time) const
 {
     return positionTrace_.SampleValid(time);
@@ -59,6 +59,14 @@ public:
     static constexpr ReplicatedRotationMode DefaultSynchronizeRotation = ReplicatedRotationMode::XYZ;
     static constexpr bool DefaultExtrapolatePosition = true;
     static constexpr bool DefaultExtrapolateRotation = false;
+    static constexpr bool DefaultQuantize = false;
+    static constexpr float DefaultPositionRange = 1024.0f;
+    static constexpr unsigned DefaultPositionBits = 20;
+    static constexpr float DefaultVelocityRange = 4.0f;
+    static constexpr unsigned DefaultVelocityBits = 12;
+    static constexpr unsigned DefaultRotationBits = 12;
+    static constexpr float DefaultAngularVelocityRange = 4.0f;
+    static constexpr unsigned DefaultAngularVelocityBits = 10;
 
     static constexpr NetworkCallbackFlags CallbackMask =
         NetworkCallbackMask::UpdateTransformOnServer | NetworkCallbackMask::UnreliableDelta | NetworkCallbackMask::InterpolateState;
@@ -92,6 +100,27 @@ public:
     void SetExtrapolateRotation(bool value) { extrapolateRotation_ = value; }
     bool GetExtrapolateRotation() const { return extrapolateRotation_; }
 
+    /// Quantization of unreliable updates. Positions outside of the range are clamped.
+    /// Velocities are measured per network frame.
+    /// @{
+    void SetQuantize(bool value) { quantize_ = value; }
+    bool GetQuantize() const { return quantize_; }
+    void SetPositionRange(float value) { positionRange_ = value; }
+    float GetPositionRange() const { return positionRange_; }
+    void SetPositionBits(unsigned value) { positionBits_ = value; }
+    unsigned GetPositionBits() const { return positionBits_; }
+    void SetVelocityRange(float value) { velocityRange_ = value; }
+    float GetVelocityRange() const { return velocityRange_; }
+    void SetVelocityBits(unsigned value) { velocityBits_ = value; }
+    unsigned GetVelocityBits() const { return velocityBits_; }
+    void SetRotationBits(unsigned value) { rotationBits_ = value; }
+    unsigned GetRotationBits() const { return rotationBits_; }
+    void SetAngularVelocityRange(float value) { angularVelocityRange_ = value; }
+    float GetAngularVelocityRange() const { return angularVelocityRange_; }
+    void SetAngularVelocityBits(unsigned value) { angularVelocityBits_ = value; }
+    unsigned GetAngularVelocityBits() const { return angularVelocityBits_; }
+    /// @}
+
     /// Implement NetworkBehavior.
     /// @{
     void InitializeOnServer() override;
@@ -118,6 +147,8 @@ public:
 private:
     void InitializeCommon();
     void OnServerFrameEnd(NetworkFrame frame);
+    void WriteQuantizedDelta(Serializer& dest) const;
+    void ReadQuantizedDelta(NetworkFrame frame, Deserializer& src);
 
     /// Attributes independent on the client and the server.
     /// @{
@@ -136,6 +167,14 @@ private:
     ReplicatedRotationMode synchronizeRotation_{DefaultSynchronizeRotation};
     bool extrapolatePosition_{DefaultExtrapolatePosition};
     bool extrapolateRotation_{DefaultExtrapolateRotation};
+    bool quantize_{DefaultQuantize};
+    float positionRange_{DefaultPositionRange};
+    unsigned positionBits_{DefaultPositionBits};
+    float velocityRange_{DefaultVelocityRange};
+    unsigned velocityBits_{DefaultVelocityBits};
+    unsigned rotationBits_{DefaultRotationBits};
+    float angularVelocityRange_{DefaultAngularVelocityRange};
+    unsigned angularVelocityBits_{DefaultAngularVelocityBits};
     /// @}
 
     NetworkValue<PositionAndVelocity> positionTrace_;
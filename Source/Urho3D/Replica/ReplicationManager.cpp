@@ -109,6 +109,7 @@ void NetworkObjectRegistry::RemoveAllNetworkObjects()
     }
 
     networkObjectsDirty_.clear();
+    spatialIndex_.clear();
 
     URHO3D_LOGINFO("{} instances of NetworkObject removed", nodesToRemove.size());
 }
@@ -151,6 +152,76 @@ void NetworkObjectRegistry::GetSortedNetworkObjects(ea::vector<NetworkObject*>&
     }
 }
 
+void NetworkObjectRegistry::UpdateSpatialIndex(float cellSize)
+{
+    spatialIndexCellSize_ = ea::max(0.0f, cellSize);
+
+    // Keep cells allocated, they are likely to be reused next frame
+    for (auto& [cell, networkObjects] : spatialIndex_)
+        networkObjects.clear();
+
+    if (spatialIndexCellSize_ == 0.0f)
+        return;
+
+    for (NetworkObject* networkObject : GetNetworkObjects())
+    {
+        const IntVector3 cell = GetSpatialIndexCell(networkObject->GetNode()->GetWorldPosition());
+        spatialIndex_[cell].push_back(networkObject);
+    }
+}
+
+void NetworkObjectRegistry::QueryNetworkObjectsInRadius(
+    const Vector3& center, float radius, ea::vector<NetworkObject*>& result) const
+{
+    URHO3D_ASSERT(HasSpatialIndex());
+
+    const IntVector3 beginCell = GetSpatialIndexCell(center - Vector3::ONE * radius);
+    const IntVector3 endCell = GetSpatialIndexCell(center + Vector3::ONE * radius);
+    const float radiusSquared = radius * radius;
+
+    const auto queryCell = [&](const ea::vector<NetworkObject*>& networkObjects)
+    {
+        for (NetworkObject* networkObject : networkObjects)
+        {
+            const Vector3 offset = networkObject->GetNode()->GetWorldPosition() - center;
+            if (offset.LengthSquared() <= radiusSquared)
+                result.push_back(networkObject);
+        }
+    };
+
+    // Iterate all non-empty cells instead if the query covers more cells than there are in the index
+    const IntVector3 size = endCell - beginCell + IntVector3::ONE;
+    const long long numCells = static_cast<long long>(size.x_) * size.y_ * size.z_;
+    if (numCells > static_cast<long long>(spatialIndex_.size()))
+    {
+        for (const auto& [cell, networkObjects] : spatialIndex_)
+        {
+            if (cell.x_ >= beginCell.x_ && cell.y_ >= beginCell.y_ && cell.z_ >= beginCell.z_
+                && cell.x_ <= endCell.x_ && cell.y_ <= endCell.y_ && cell.z_ <= endCell.z_)
+                queryCell(networkObjects);
+        }
+        return;
+    }
+
+    for (int z = beginCell.z_; z <= endCell.z_; ++z)
+    {
+        for (int y = beginCell.y_; y <= endCell.y_; ++y)
+        {
+            for (int x = beginCell.x_; x <= endCell.x_; ++x)
+            {
+                const auto iter = spatialIndex_.find(IntVector3{x, y, z});
+                if (iter != spatialIndex_.end())
+                    queryCell(iter->second);
+            }
+        }
+    }
+}
+
+IntVector3 NetworkObjectRegistry::GetSpatialIndexCell(const Vector3& position) const
+{
+    return VectorFloorToInt(position / spatialIndexCellSize_);
+}
+
 ea::string ReplicationManager::GetDebugInfo() const
 {
     if (client_ && client_->replica_)
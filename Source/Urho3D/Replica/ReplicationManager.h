@@ -34,6 +34,7 @@
 #include "../Scene/TrackedComponent.h"
 
 #include <EASTL/optional.h>
+#include <EASTL/unordered_map.h>
 #include <EASTL/unordered_set.h>
 
 namespace Urho3D
@@ -68,14 +69,28 @@ public:
     void GetSortedNetworkObjects(ea::vector<NetworkObject*>& networkObjects) const;
     /// @}
 
+    /// Spatial index of NetworkObject-s used for interest management.
+    /// Index is a hash grid of world positions, it is not updated automatically.
+    /// @{
+    void UpdateSpatialIndex(float cellSize);
+    void QueryNetworkObjectsInRadius(const Vector3& center, float radius, ea::vector<NetworkObject*>& result) const;
+    bool HasSpatialIndex() const { return spatialIndexCellSize_ > 0.0f; }
+    float GetSpatialIndexCellSize() const { return spatialIndexCellSize_; }
+    /// @}
+
     NetworkObjectSpan GetNetworkObjects() const { return StaticCastSpan<NetworkObject* const>(GetTrackedComponents()); }
     unsigned GetNetworkIndexUpperBound() const { return GetReferenceIndexUpperBound(); }
     NetworkObject* GetNetworkObject(NetworkId networkId, bool checkVersion = true) const;
     NetworkObject* GetNetworkObjectByIndex(unsigned networkIndex) const;
 
 private:
+    IntVector3 GetSpatialIndexCell(const Vector3& position) const;
+
     ea::vector<bool> networkObjectsDirty_;
 
+    float spatialIndexCellSize_{};
+    ea::unordered_map<IntVector3, ea::vector<NetworkObject*>> spatialIndex_;
+
 protected:
     void OnComponentAdded(TrackedComponentBase* baseComponent) override;
     void OnComponentRemoved(TrackedComponentBase* baseComponent) override;
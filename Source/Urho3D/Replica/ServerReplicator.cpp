@@ -22,10 +22,13 @@
 
 #include <Urho3D/Precompiled.h>
 
+#include <Urho3D/Container/Hash.h>
 #include <Urho3D/Core/Context.h>
 #include <Urho3D/Core/CoreEvents.h>
 #include <Urho3D/Core/Exception.h>
 #include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/IO/Compression.h>
 #include <Urho3D/IO/Log.h>
 #include <Urho3D/Math/RandomEngine.h>
 #include <Urho3D/Network/Connection.h>
@@ -39,6 +42,7 @@
 #include <Urho3D/Scene/SceneEvents.h>
 
 #include <EASTL/numeric.h>
+#include <EASTL/sort.h>
 
 namespace Urho3D
 {
@@ -53,8 +57,13 @@ unsigned GetIndex(NetworkId networkId)
 
 } // namespace
 
-SharedReplicationState::SharedReplicationState(NetworkObjectRegistry* objectRegistry)
+SharedReplicationState::SharedReplicationState(NetworkObjectRegistry* objectRegistry, WorkQueue* workQueue,
+    unsigned deltaCompressionHistory, unsigned snapshotDictionarySize)
     : objectRegistry_(objectRegistry)
+    , workQueue_(workQueue)
+    , deltaCompressionHistory_(deltaCompressionHistory)
+    , unreliableFrames_(ea::max(1u, deltaCompressionHistory))
+    , maxSnapshotDictionarySize_(ea::min(snapshotDictionarySize, MaxCompressionDictionarySize))
 {
     URHO3D_ASSERT(objectRegistry_);
 
@@ -72,6 +81,10 @@ void SharedReplicationState::OnNetworkObjectAdded(NetworkObject* networkObject)
 
 void SharedReplicationState::OnNetworkObjectRemoved(NetworkObject* networkObject)
 {
+    const unsigned index = GetIndex(networkObject->GetNetworkId());
+    if (index < snapshotSizes_.size())
+        snapshotSizes_[index] = 0;
+
     if (recentlyAddedObjects_.erase(networkObject->GetNetworkId()) == 0)
         recentlyRemovedObjects_.insert(networkObject->GetNetworkId());
 
@@ -91,6 +104,10 @@ void SharedReplicationState::PrepareForUpdate()
 
     objectRegistry_->UpdateNetworkObjects();
     objectRegistry_->GetSortedNetworkObjects(sortedNetworkObjects_);
+
+    // Update cached world transforms in advance, they may be read from multiple threads later
+    for (NetworkObject* networkObject : sortedNetworkObjects_)
+        networkObject->GetNode()->GetWorldTransform();
 }
 
 void SharedReplicationState::ResetFrameBuffers()
@@ -100,15 +117,45 @@ void SharedReplicationState::ResetFrameBuffers()
     isDeltaUpdateQueued_.clear();
     isDeltaUpdateQueued_.resize(indexUppedBound);
 
+    isSnapshotQueued_.clear();
+    isSnapshotQueued_.resize(indexUppedBound);
+    snapshotData_.resize(indexUppedBound);
+    snapshotSizes_.resize(indexUppedBound);
+
     needReliableDeltaUpdate_.clear();
     needReliableDeltaUpdate_.resize(indexUppedBound);
     reliableDeltaUpdateData_.resize(indexUppedBound);
 
-    needUnreliableDeltaUpdate_.clear();
-    needUnreliableDeltaUpdate_.resize(indexUppedBound);
-    unreliableDeltaUpdateData_.resize(indexUppedBound);
+    deltaUpdateBuffers_.resize(WorkQueue::GetThreadIndexCount());
+    for (VectorBuffer& buffer : deltaUpdateBuffers_)
+        buffer.Clear();
 
-    deltaUpdateBuffer_.Clear();
+    if (trafficBreakdownEnabled_)
+    {
+        for (auto* traffic : {&snapshotTraffic_, &reliableTraffic_, &unreliableTraffic_})
+        {
+            traffic->resize(indexUppedBound);
+            for (NetworkComponentTrafficVector& objectTraffic : *traffic)
+                objectTraffic.clear();
+        }
+    }
+}
+
+SharedReplicationState::UnreliableFrameData& SharedReplicationState::ResetUnreliableFrame(NetworkFrame frame)
+{
+    const unsigned indexUppedBound = GetIndexUpperBound();
+
+    currentUnreliableFrame_ = GetFrameRingIndex(frame, unreliableFrames_.size());
+    UnreliableFrameData& frameData = unreliableFrames_[currentUnreliableFrame_];
+
+    frameData.frame_ = frame;
+    frameData.buffers_.resize(WorkQueue::GetThreadIndexCount());
+    for (VectorBuffer& buffer : frameData.buffers_)
+        buffer.Clear();
+    frameData.needUpdate_.clear();
+    frameData.needUpdate_.resize(indexUppedBound);
+    frameData.spans_.resize(indexUppedBound);
+    return frameData;
 }
 
 void SharedReplicationState::InitializeNewObjects()
@@ -137,38 +184,120 @@ void SharedReplicationState::QueueDeltaUpdate(NetworkObject* networkObject)
     isDeltaUpdateQueued_[index] = true;
 }
 
+void SharedReplicationState::QueueSnapshot(NetworkObject* networkObject)
+{
+    const unsigned index = GetIndex(networkObject->GetNetworkId());
+    isSnapshotQueued_[index] = true;
+}
+
 void SharedReplicationState::CookDeltaUpdates(NetworkFrame currentFrame)
 {
     recentlyRemovedObjects_.clear();
 
+    UnreliableFrameData& unreliableFrame = ResetUnreliableFrame(currentFrame);
+
+    cookingQueue_.clear();
     for (unsigned i = 0; i < isDeltaUpdateQueued_.size(); ++i)
     {
-        if (!isDeltaUpdateQueued_[i])
+        if (isDeltaUpdateQueued_[i] || isSnapshotQueued_[i])
+            cookingQueue_.push_back(i);
+    }
+
+    // Each object is cooked by single thread, so behaviors of the same object are never called concurrently
+    const auto cookObjects = [&](unsigned beginIndex, unsigned endIndex)
+    {
+        const unsigned threadIndex = WorkQueue::GetThreadIndex();
+        for (unsigned i = beginIndex; i < endIndex; ++i)
+            CookObject(currentFrame, cookingQueue_[i], threadIndex, unreliableFrame);
+    };
+
+    if (workQueue_)
+        ForEachParallel(workQueue_, CookingBatchSize, cookingQueue_.size(), cookObjects);
+    else
+        cookObjects(0, cookingQueue_.size());
+
+    UpdateSnapshotDictionary();
+}
+
+void SharedReplicationState::UpdateSnapshotDictionary()
+{
+    if (snapshotDictionary_.size() >= maxSnapshotDictionarySize_)
+        return;
+
+    // Objects of the same kind usually have the same type and snapshot size, one sample of each kind is enough
+    for (unsigned index : cookingQueue_)
+    {
+        if (!isSnapshotQueued_[index])
             continue;
 
-        NetworkObject* networkObject = objectRegistry_->GetNetworkObjectByIndex(i);
-        URHO3D_ASSERT(networkObject);
+        const ConstByteSpan snapshot = GetSnapshotByIndex(index);
+        NetworkObject* networkObject = objectRegistry_->GetNetworkObjectByIndex(index);
+
+        unsigned key = networkObject->GetType().Value();
+        CombineHash(key, snapshot.size());
+        if (snapshotDictionaryKeys_.contains(key))
+            continue;
 
+        if (snapshotDictionary_.size() + snapshot.size() > maxSnapshotDictionarySize_)
+            continue;
+
+        snapshotDictionaryKeys_.insert(key);
+        snapshotDictionary_.insert(snapshotDictionary_.end(), snapshot.begin(), snapshot.end());
+    }
+}
+
+void SharedReplicationState::CookObject(
+    NetworkFrame currentFrame, unsigned index, unsigned threadIndex, UnreliableFrameData& unreliableFrame)
+{
+    NetworkObject* networkObject = objectRegistry_->GetNetworkObjectByIndex(index);
+    URHO3D_ASSERT(networkObject);
+
+    const auto setTrafficBreakdown = [&](ea::vector<NetworkComponentTrafficVector>& traffic)
+    {
+        const bool enabled = trafficBreakdownEnabled_ && index < traffic.size();
+        networkObject->SetTrafficBreakdown(enabled ? &traffic[index] : nullptr);
+    };
+
+    VectorBuffer& buffer = deltaUpdateBuffers_[threadIndex];
+    if (isDeltaUpdateQueued_[index])
+    {
         if (networkObject->PrepareReliableDelta(currentFrame))
         {
-            const unsigned beginOffset = deltaUpdateBuffer_.Tell();
-            networkObject->WriteReliableDelta(currentFrame, deltaUpdateBuffer_);
-            const unsigned endOffset = deltaUpdateBuffer_.Tell();
+            setTrafficBreakdown(reliableTraffic_);
+            const unsigned beginOffset = buffer.Tell();
+            networkObject->WriteReliableDelta(currentFrame, buffer);
+            const unsigned endOffset = buffer.Tell();
 
-            needReliableDeltaUpdate_[i] = true;
-            reliableDeltaUpdateData_[i] = {beginOffset, endOffset};
+            needReliableDeltaUpdate_[index] = true;
+            reliableDeltaUpdateData_[index] = {threadIndex, beginOffset, endOffset};
         }
 
         if (networkObject->PrepareUnreliableDelta(currentFrame))
         {
-            const unsigned beginOffset = deltaUpdateBuffer_.Tell();
-            networkObject->WriteUnreliableDelta(currentFrame, deltaUpdateBuffer_);
-            const unsigned endOffset = deltaUpdateBuffer_.Tell();
-
-            needUnreliableDeltaUpdate_[i] = true;
-            unreliableDeltaUpdateData_[i] = {beginOffset, endOffset};
+            VectorBuffer& unreliableBuffer = unreliableFrame.buffers_[threadIndex];
+            setTrafficBreakdown(unreliableTraffic_);
+            const unsigned beginOffset = unreliableBuffer.Tell();
+            networkObject->WriteUnreliableDelta(currentFrame, unreliableBuffer);
+            const unsigned endOffset = unreliableBuffer.Tell();
+
+            unreliableFrame.needUpdate_[index] = true;
+            unreliableFrame.spans_[index] = {threadIndex, beginOffset, endOffset};
         }
     }
+
+    // Snapshots are the same for all clients, so they are written once after deltas
+    if (isSnapshotQueued_[index])
+    {
+        setTrafficBreakdown(snapshotTraffic_);
+        const unsigned beginOffset = buffer.Tell();
+        networkObject->WriteSnapshot(currentFrame, buffer);
+        const unsigned endOffset = buffer.Tell();
+
+        snapshotData_[index] = {threadIndex, beginOffset, endOffset};
+        snapshotSizes_[index] = endOffset - beginOffset;
+    }
+
+    networkObject->SetTrafficBreakdown(nullptr);
 }
 
 unsigned SharedReplicationState::GetIndexUpperBound() const
@@ -191,19 +320,71 @@ ea::optional<ConstByteSpan> SharedReplicationState::GetReliableUpdateByIndex(uns
     return GetSpanData(reliableDeltaUpdateData_[index]);
 }
 
+ConstByteSpan SharedReplicationState::GetSnapshotByIndex(unsigned index) const
+{
+    URHO3D_ASSERT(isSnapshotQueued_[index]);
+    return GetSpanData(snapshotData_[index]);
+}
+
 ea::optional<ConstByteSpan> SharedReplicationState::GetUnreliableUpdateByIndex(unsigned index) const
 {
-    if (!needUnreliableDeltaUpdate_[index])
+    return GetUnreliableSpanData(unreliableFrames_[currentUnreliableFrame_], index);
+}
+
+ea::optional<ConstByteSpan> SharedReplicationState::GetUnreliableUpdateByIndex(unsigned index, NetworkFrame frame) const
+{
+    const unsigned frameIndex = GetFrameRingIndex(frame, unreliableFrames_.size());
+    const UnreliableFrameData& frameData = unreliableFrames_[frameIndex];
+    if (frameData.frame_ != frame)
         return ea::nullopt;
-    return GetSpanData(unreliableDeltaUpdateData_[index]);
+    return GetUnreliableSpanData(frameData, index);
+}
+
+unsigned SharedReplicationState::GetEstimatedSnapshotSize(unsigned index) const
+{
+    const unsigned size = index < snapshotSizes_.size() ? snapshotSizes_[index] : 0;
+    return size != 0 ? size : DefaultSnapshotSizeEstimate;
+}
+
+const NetworkComponentTrafficVector& SharedReplicationState::GetSnapshotTrafficByIndex(unsigned index) const
+{
+    return GetTrafficByIndex(snapshotTraffic_, index);
+}
+
+const NetworkComponentTrafficVector& SharedReplicationState::GetReliableTrafficByIndex(unsigned index) const
+{
+    return GetTrafficByIndex(reliableTraffic_, index);
+}
+
+const NetworkComponentTrafficVector& SharedReplicationState::GetUnreliableTrafficByIndex(unsigned index) const
+{
+    return GetTrafficByIndex(unreliableTraffic_, index);
+}
+
+const NetworkComponentTrafficVector& SharedReplicationState::GetTrafficByIndex(
+    const ea::vector<NetworkComponentTrafficVector>& traffic, unsigned index) const
+{
+    static const NetworkComponentTrafficVector emptyTraffic;
+    return trafficBreakdownEnabled_ && index < traffic.size() ? traffic[index] : emptyTraffic;
 }
 
 ConstByteSpan SharedReplicationState::GetSpanData(const DeltaBufferSpan& span) const
 {
-    const auto data = deltaUpdateBuffer_.GetData();
+    const auto data = deltaUpdateBuffers_[span.bufferIndex_].GetData();
     return {data + span.beginOffset_, span.endOffset_ - span.beginOffset_};
 }
 
+ea::optional<ConstByteSpan> SharedReplicationState::GetUnreliableSpanData(
+    const UnreliableFrameData& frameData, unsigned index) const
+{
+    if (index >= frameData.needUpdate_.size() || !frameData.needUpdate_[index])
+        return ea::nullopt;
+
+    const DeltaBufferSpan& span = frameData.spans_[index];
+    const auto data = frameData.buffers_[span.bufferIndex_].GetData();
+    return ConstByteSpan{data + span.beginOffset_, span.endOffset_ - span.beginOffset_};
+}
+
 ClientSynchronizationState::ClientSynchronizationState(
     NetworkObjectRegistry* objectRegistry, AbstractConnection* connection, const VariantMap& settings)
     : objectRegistry_(objectRegistry)
@@ -320,22 +501,63 @@ unsigned ClientSynchronizationState::MakeMagic() const
 ClientReplicationState::ClientReplicationState(
     NetworkObjectRegistry* objectRegistry, AbstractConnection* connection, const VariantMap& settings)
     : ClientSynchronizationState(objectRegistry, connection, settings)
+    , sentUnreliableFrames_(GetSetting(NetworkSettings::DeltaCompressionHistory).GetUInt())
 {
 }
 
-void ClientReplicationState::SendMessages(NetworkFrame currentFrame, const SharedReplicationState& sharedState)
+template <class T>
+void ClientReplicationState::PrepareGeneratedMessage(NetworkMessageId messageId, PacketType packetType, T generator)
 {
-    ClientSynchronizationState::SendMessages();
+    if (numPreparedMessages_ >= preparedMessages_.size())
+        preparedMessages_.emplace_back();
+
+    PreparedMessage& preparedMessage = preparedMessages_[numPreparedMessages_];
+    preparedMessage.messageId_ = messageId;
+    preparedMessage.packetType_ = packetType;
+    preparedMessage.data_.Clear();
+    preparedMessage.debugInfo_.clear();
+
+#ifdef URHO3D_LOGGING
+    ea::string* debugInfoPtr = &preparedMessage.debugInfo_;
+#else
+    ea::string* debugInfoPtr = nullptr;
+#endif
+
+    if (generator(preparedMessage.data_, debugInfoPtr))
+        ++numPreparedMessages_;
+}
+
+void ClientReplicationState::PrepareMessages(NetworkFrame currentFrame, const SharedReplicationState& sharedState)
+{
+    numPreparedMessages_ = 0;
 
     if (IsSynchronized())
     {
-        SendRemoveObjects();
-        SendAddObjects();
-        SendUpdateObjectsReliable(sharedState);
-        SendUpdateObjectsUnreliable(currentFrame, sharedState);
+        PrepareRemoveObjects();
+        PrepareAddObjects(sharedState);
+        PrepareUpdateObjectsReliable(sharedState);
+        PrepareUpdateObjectsUnreliable(currentFrame, sharedState);
     }
 }
 
+void ClientReplicationState::SendMessages()
+{
+    ClientSynchronizationState::SendMessages();
+
+    for (unsigned i = 0; i < numPreparedMessages_; ++i)
+    {
+        const PreparedMessage& preparedMessage = preparedMessages_[i];
+        const PacketType packetType = preparedMessage.packetType_;
+        const bool reliable = packetType == PT_RELIABLE_ORDERED || packetType == PT_RELIABLE_UNORDERED;
+        const bool inOrder = packetType == PT_RELIABLE_ORDERED || packetType == PT_UNRELIABLE_ORDERED;
+
+        const VectorBuffer& data = preparedMessage.data_;
+        connection_->SendLoggedMessage(preparedMessage.messageId_, reliable, inOrder, data.GetData(), data.GetSize(),
+            preparedMessage.debugInfo_);
+    }
+    numPreparedMessages_ = 0;
+}
+
 bool ClientReplicationState::ProcessMessage(NetworkMessageId messageId, MemoryBuffer& messageData)
 {
     if (ClientSynchronizationState::ProcessMessage(messageId, messageData))
@@ -349,6 +571,15 @@ bool ClientReplicationState::ProcessMessage(NetworkMessageId messageId, MemoryBu
         ProcessObjectsFeedbackUnreliable(messageData);
         return true;
 
+    case MSG_UPDATE_OBJECTS_ACK:
+    {
+        const auto& msg = ReadNetworkMessage<MsgUpdateObjectsAck>(messageData);
+        connection_->OnMessageReceived(messageId, msg);
+
+        ProcessUpdateObjectsAck(msg);
+        return true;
+    }
+
     default: return false;
     }
 }
@@ -390,9 +621,49 @@ void ClientReplicationState::ProcessObjectsFeedbackUnreliable(MemoryBuffer& mess
     }
 }
 
-void ClientReplicationState::SendRemoveObjects()
+void ClientReplicationState::ProcessUpdateObjectsAck(const MsgUpdateObjectsAck& msg)
+{
+    if (!IsSynchronized() || sentUnreliableFrames_.empty())
+        return;
+
+    AcknowledgeFrame(msg.latestFrame_);
+    for (unsigned i = 0; i < MsgUpdateObjectsAck::MaxPreviousFrames; ++i)
+    {
+        if (msg.previousFramesMask_ & (1u << i))
+            AcknowledgeFrame(msg.latestFrame_ - (i + 1));
+    }
+}
+
+void ClientReplicationState::AcknowledgeFrame(NetworkFrame frame)
 {
-    connection_->SendGeneratedMessage(MSG_REMOVE_OBJECTS, PT_RELIABLE_ORDERED,
+    SentUnreliableFrame& sentFrame = sentUnreliableFrames_[GetFrameRingIndex(frame, sentUnreliableFrames_.size())];
+    if (sentFrame.frame_ != frame)
+        return;
+
+    for (unsigned index : sentFrame.indices_)
+    {
+        // Ignore updates sent before the object snapshot, they may belong to another object
+        if (objectsRelevance_[index] == NetworkObjectRelevance::Irrelevant || frame <= objectsSnapshotFrames_[index])
+            continue;
+
+        ea::optional<NetworkFrame>& baselineFrame = objectsBaselineFrames_[index];
+        if (!baselineFrame || *baselineFrame < frame)
+            baselineFrame = frame;
+    }
+
+    // Each frame is acknowledged only once
+    sentFrame.frame_ = ea::nullopt;
+}
+
+void ClientReplicationState::ResetBaseline(unsigned index, NetworkFrame currentFrame)
+{
+    objectsBaselineFrames_[index] = ea::nullopt;
+    objectsSnapshotFrames_[index] = currentFrame;
+}
+
+void ClientReplicationState::PrepareRemoveObjects()
+{
+    PrepareGeneratedMessage(MSG_REMOVE_OBJECTS, PT_RELIABLE_ORDERED,
         [&](VectorBuffer& msg, ea::string* debugInfo)
     {
         if (debugInfo)
@@ -414,27 +685,34 @@ void ClientReplicationState::SendRemoveObjects()
     });
 }
 
-void ClientReplicationState::SendAddObjects()
+void ClientReplicationState::PrepareAddObjects(const SharedReplicationState& sharedState)
 {
-    connection_->SendGeneratedMessage(MSG_ADD_OBJECTS, PT_RELIABLE_ORDERED,
+    PrepareGeneratedMessage(MSG_ADD_OBJECTS, PT_RELIABLE_ORDERED,
         [&](VectorBuffer& msg, ea::string* debugInfo)
     {
-        msg.WriteInt64(static_cast<long long>(GetCurrentFrame()));
-
-        bool sendMessage = false;
+        // Snapshots are written into separate buffer so they can be compressed together
+        snapshotBuffer_.Clear();
+        unsigned numSnapshots = 0;
         for (const auto& [networkObject, isSnapshot] : pendingUpdatedObjects_)
         {
             if (!isSnapshot)
                 continue;
 
-            sendMessage = true;
-            msg.WriteUInt(static_cast<unsigned>(networkObject->GetNetworkId()));
-            msg.WriteStringHash(networkObject->GetType());
-            msg.WriteVLE(networkObject->GetOwnerConnectionId());
+            ++numSnapshots;
+            snapshotBuffer_.WriteUInt(static_cast<unsigned>(networkObject->GetNetworkId()));
+            snapshotBuffer_.WriteStringHash(networkObject->GetType());
+            snapshotBuffer_.WriteVLE(networkObject->GetOwnerConnectionId());
+
+            const unsigned index = GetIndex(networkObject->GetNetworkId());
+            const ConstByteSpan snapshot = sharedState.GetSnapshotByIndex(index);
+            snapshotBuffer_.WriteVLE(snapshot.size());
+            snapshotBuffer_.Write(snapshot.data(), snapshot.size());
 
-            componentBuffer_.Clear();
-            networkObject->WriteSnapshot(GetCurrentFrame(), componentBuffer_);
-            msg.WriteBuffer(componentBuffer_.GetBuffer());
+            if (NetworkStatistics* statistics = connection_->GetTrafficStatistics())
+            {
+                statistics->RecordObject(networkObject, true, snapshot.size(), snapshot.size(),
+                    sharedState.GetSnapshotTrafficByIndex(index));
+            }
 
             if (debugInfo)
             {
@@ -443,13 +721,55 @@ void ClientReplicationState::SendAddObjects()
                 debugInfo->append(ToString(networkObject->GetNetworkId()));
             }
         }
-        return sendMessage;
+
+        if (numSnapshots == 0)
+            return false;
+
+        msg.WriteInt64(static_cast<long long>(GetCurrentFrame()));
+        msg.WriteVLE(snapshotStats_.numSnapshotsPending_);
+
+        const unsigned headerSize = msg.GetSize();
+        const unsigned rawSize = snapshotBuffer_.GetSize();
+
+        unsigned compressedSize = 0;
+        if (GetSetting(NetworkSettings::SnapshotCompression).GetBool())
+        {
+            // Send new part of the dictionary, if any
+            const ByteVector& dictionary = sharedState.GetSnapshotDictionary();
+            const unsigned dictionaryAppendSize = dictionary.size() - sentSnapshotDictionarySize_;
+            msg.WriteVLE(dictionaryAppendSize);
+            msg.Write(dictionary.data() + sentSnapshotDictionarySize_, dictionaryAppendSize);
+            sentSnapshotDictionarySize_ = dictionary.size();
+
+            compressedSnapshotBuffer_.resize(EstimateCompressBound(rawSize));
+            compressedSize = CompressDataWithDictionary(compressedSnapshotBuffer_.data(), snapshotBuffer_.GetData(),
+                rawSize, dictionary.data(), dictionary.size());
+        }
+        else
+            msg.WriteVLE(0);
+
+        // Zero size means that snapshots are not compressed
+        if (compressedSize != 0 && compressedSize < rawSize)
+        {
+            msg.WriteVLE(rawSize);
+            msg.Write(compressedSnapshotBuffer_.data(), compressedSize);
+        }
+        else
+        {
+            msg.WriteVLE(0);
+            msg.Write(snapshotBuffer_.GetData(), rawSize);
+        }
+
+        snapshotStats_.numSnapshotsSent_ += numSnapshots;
+        snapshotStats_.numRawBytes_ += rawSize;
+        snapshotStats_.numCompressedBytes_ += msg.GetSize() - headerSize;
+        return true;
     });
 }
 
-void ClientReplicationState::SendUpdateObjectsReliable(const SharedReplicationState& sharedState)
+void ClientReplicationState::PrepareUpdateObjectsReliable(const SharedReplicationState& sharedState)
 {
-    connection_->SendGeneratedMessage(MSG_UPDATE_OBJECTS_RELIABLE, PT_RELIABLE_ORDERED,
+    PrepareGeneratedMessage(MSG_UPDATE_OBJECTS_RELIABLE, PT_RELIABLE_ORDERED,
         [&](VectorBuffer& msg, ea::string* debugInfo)
     {
         msg.WriteInt64(static_cast<long long>(GetCurrentFrame()));
@@ -472,6 +792,12 @@ void ClientReplicationState::SendUpdateObjectsReliable(const SharedReplicationSt
             msg.WriteVLE(updateSpan->size());
             msg.Write(updateSpan->data(), updateSpan->size());
 
+            if (NetworkStatistics* statistics = connection_->GetTrafficStatistics())
+            {
+                statistics->RecordObject(networkObject, true, updateSpan->size(), updateSpan->size(),
+                    sharedState.GetReliableTrafficByIndex(index));
+            }
+
             if (debugInfo)
             {
                 if (!debugInfo->empty())
@@ -483,41 +809,106 @@ void ClientReplicationState::SendUpdateObjectsReliable(const SharedReplicationSt
     });
 }
 
-void ClientReplicationState::SendUpdateObjectsUnreliable(
+void ClientReplicationState::PrepareUpdateObjectsUnreliable(
     NetworkFrame currentFrame, const SharedReplicationState& sharedState)
 {
-    connection_->SendGeneratedMessage(MSG_UPDATE_OBJECTS_UNRELIABLE, PT_UNRELIABLE_UNORDERED,
-        [&](VectorBuffer& msg, ea::string* debugInfo)
+    SentUnreliableFrame* sentFrame = nullptr;
+    if (!sentUnreliableFrames_.empty())
     {
-        bool sendMessage = false;
+        sentFrame = &sentUnreliableFrames_[GetFrameRingIndex(currentFrame, sentUnreliableFrames_.size())];
+        sentFrame->frame_ = currentFrame;
+        sentFrame->indices_.clear();
+    }
+
+    // Collect objects that need update in this frame
+    unreliableUpdateQueue_.clear();
+    for (const auto& [networkObject, isSnapshot] : pendingUpdatedObjects_)
+    {
+        // Skip redundant updates, both if update is empty or if snapshot was already sent
+        const unsigned index = GetIndex(networkObject->GetNetworkId());
+        if (isSnapshot)
+            continue;
+
+        if (!sharedState.GetUnreliableUpdateByIndex(index))
+            continue;
 
+        const NetworkObjectRelevance relevance = objectsRelevance_[index];
+        URHO3D_ASSERT(relevance != NetworkObjectRelevance::Irrelevant);
+        if (relevance == NetworkObjectRelevance::NoUpdates)
+            continue;
+
+        if (static_cast<long long>(currentFrame) % static_cast<unsigned>(relevance) != 0)
+            continue;
+
+        unreliableUpdateQueue_.push_back(networkObject);
+    }
+
+    // Send the most important objects first if bandwidth is limited
+    const unsigned updateBudget = GetSetting(NetworkSettings::UnreliableUpdateBudget).GetUInt();
+    if (updateBudget != 0)
+        SortUnreliableUpdatesByPriority(sharedState);
+
+    priorityStats_.numUpdatesSent_ = 0;
+    priorityStats_.numUpdatesDeferred_ = 0;
+    priorityStats_.numBytesSent_ = 0;
+
+    PrepareGeneratedMessage(MSG_UPDATE_OBJECTS_UNRELIABLE, PT_UNRELIABLE_UNORDERED,
+        [&](VectorBuffer& msg, ea::string* debugInfo)
+    {
         msg.WriteInt64(static_cast<long long>(GetCurrentFrame()));
 
-        for (const auto& [networkObject, isSnapshot] : pendingUpdatedObjects_)
+        for (NetworkObject* networkObject : unreliableUpdateQueue_)
         {
-            // Skip redundant updates, both if update is empty or if snapshot was already sent
             const unsigned index = GetIndex(networkObject->GetNetworkId());
-            if (isSnapshot)
-                continue;
-
             const auto updateSpan = sharedState.GetUnreliableUpdateByIndex(index);
-            if (!updateSpan)
-                continue;
 
-            const NetworkObjectRelevance relevance = objectsRelevance_[index];
-            URHO3D_ASSERT(relevance != NetworkObjectRelevance::Irrelevant);
-            if (relevance == NetworkObjectRelevance::NoUpdates)
-                continue;
-
-            if (static_cast<long long>(currentFrame) % static_cast<unsigned>(relevance) != 0)
-                continue;
-
-            sendMessage = true;
+            const unsigned objectOffset = msg.GetSize();
             msg.WriteUInt(static_cast<unsigned>(networkObject->GetNetworkId()));
             msg.WriteStringHash(networkObject->GetType());
 
-            msg.WriteVLE(updateSpan->size());
-            msg.Write(updateSpan->data(), updateSpan->size());
+            // Encode update as delta against the latest update acknowledged by the client, if it's still available
+            const auto baselineFrame = objectsBaselineFrames_[index];
+            const auto baselineSpan =
+                baselineFrame ? sharedState.GetUnreliableUpdateByIndex(index, *baselineFrame) : ea::nullopt;
+
+            bool isDeltaEncoded = false;
+            if (baselineSpan)
+            {
+                deltaBuffer_.Clear();
+                EncodeDeltaUpdate(*baselineSpan, *updateSpan, deltaBuffer_);
+                isDeltaEncoded = deltaBuffer_.GetSize() < updateSpan->size();
+            }
+
+            if (isDeltaEncoded)
+            {
+                msg.WriteVLE(static_cast<unsigned>(currentFrame - *baselineFrame));
+                msg.WriteBuffer(deltaBuffer_.GetBuffer());
+            }
+            else
+            {
+                msg.WriteVLE(0);
+                msg.WriteVLE(updateSpan->size());
+                msg.Write(updateSpan->data(), updateSpan->size());
+            }
+
+            // Defer this and all remaining objects if over budget, at least one object is always sent
+            if (updateBudget != 0 && msg.GetSize() > updateBudget && priorityStats_.numUpdatesSent_ > 0)
+            {
+                msg.Resize(objectOffset);
+                break;
+            }
+
+            ++priorityStats_.numUpdatesSent_;
+            objectsPriority_[index] = 0.0f;
+            if (sentFrame)
+                sentFrame->indices_.push_back(index);
+
+            if (NetworkStatistics* statistics = connection_->GetTrafficStatistics())
+            {
+                const unsigned dataSize = isDeltaEncoded ? deltaBuffer_.GetSize() : updateSpan->size();
+                statistics->RecordObject(networkObject, false, dataSize, updateSpan->size(),
+                    sharedState.GetUnreliableTrafficByIndex(index));
+            }
 
             if (debugInfo)
             {
@@ -526,11 +917,43 @@ void ClientReplicationState::SendUpdateObjectsUnreliable(
                 debugInfo->append(ToString(networkObject->GetNetworkId()));
             }
         }
-        return sendMessage;
+
+        priorityStats_.numUpdatesDeferred_ = unreliableUpdateQueue_.size() - priorityStats_.numUpdatesSent_;
+        priorityStats_.numBytesSent_ = priorityStats_.numUpdatesSent_ > 0 ? msg.GetSize() : 0;
+        return priorityStats_.numUpdatesSent_ > 0;
     });
 }
 
-void ClientReplicationState::UpdateNetworkObjects(SharedReplicationState& sharedState)
+void ClientReplicationState::SortUnreliableUpdatesByPriority(const SharedReplicationState& sharedState)
+{
+    const auto& ownedObjects = sharedState.GetOwnedObjectsByConnection(connection_);
+    const float interestRadius = ea::max(M_EPSILON, GetSetting(NetworkSettings::InterestRadius).GetFloat());
+
+    // Accumulate priority of each object while it's waiting, so stale objects are eventually sent
+    priorityStats_.maxPriority_ = 0.0f;
+    for (NetworkObject* networkObject : unreliableUpdateQueue_)
+    {
+        const Vector3 position = networkObject->GetNode()->GetWorldPosition();
+        float distance = ownedObjects.empty() ? 0.0f : M_LARGE_VALUE;
+        for (NetworkObject* ownedObject : ownedObjects)
+            distance = ea::min(distance, (ownedObject->GetNode()->GetWorldPosition() - position).Length());
+
+        const float distanceFactor = interestRadius / (interestRadius + distance);
+        const unsigned index = GetIndex(networkObject->GetNetworkId());
+        objectsPriority_[index] += networkObject->GetUpdatePriority() * distanceFactor;
+        priorityStats_.maxPriority_ = ea::max(priorityStats_.maxPriority_, objectsPriority_[index]);
+    }
+
+    ea::stable_sort(unreliableUpdateQueue_.begin(), unreliableUpdateQueue_.end(),
+        [&](NetworkObject* lhs, NetworkObject* rhs)
+    {
+        const float lhsPriority = objectsPriority_[GetIndex(lhs->GetNetworkId())];
+        const float rhsPriority = objectsPriority_[GetIndex(rhs->GetNetworkId())];
+        return lhsPriority > rhsPriority;
+    });
+}
+
+void ClientReplicationState::UpdateNetworkObjects(const SharedReplicationState& sharedState)
 {
     if (!IsSynchronized())
         return;
@@ -541,10 +964,25 @@ void ClientReplicationState::UpdateNetworkObjects(SharedReplicationState& shared
     const unsigned indexUpperBound = sharedState.GetIndexUpperBound();
     objectsRelevance_.resize(indexUpperBound, NetworkObjectRelevance::Irrelevant);
     objectsRelevanceTimeouts_.resize(indexUpperBound);
+    objectsBaselineFrames_.resize(indexUpperBound);
+    objectsSnapshotFrames_.resize(indexUpperBound);
+    objectsInterestFlags_.resize(indexUpperBound);
+    objectsPriority_.resize(indexUpperBound);
 
     pendingRemovedObjects_.clear();
     pendingUpdatedObjects_.clear();
 
+    // Snapshot sizes are estimated before compression, so scale them by observed compression ratio
+    const unsigned snapshotBudget = GetSetting(NetworkSettings::SnapshotBudget).GetUInt();
+    const float snapshotCompressionRatio = snapshotStats_.numRawBytes_ != 0
+        ? static_cast<float>(snapshotStats_.numCompressedBytes_) / snapshotStats_.numRawBytes_
+        : 1.0f;
+    float snapshotBytes = 0.0f;
+    unsigned numSnapshots = 0;
+    snapshotStats_.numSnapshotsPending_ = 0;
+
+    UpdateInterestArea(sharedState);
+
     // Process removed components first
     for (NetworkId networkId : sharedState.GetRecentlyRemovedObjects())
     {
@@ -552,6 +990,7 @@ void ClientReplicationState::UpdateNetworkObjects(SharedReplicationState& shared
         if (objectsRelevance_[index] != NetworkObjectRelevance::Irrelevant)
         {
             objectsRelevance_[index] = NetworkObjectRelevance::Irrelevant;
+            ResetBaseline(index, GetCurrentFrame());
             pendingRemovedObjects_.push_back(networkId);
         }
     }
@@ -567,14 +1006,46 @@ void ClientReplicationState::UpdateNetworkObjects(SharedReplicationState& shared
         const bool isParentRelevant = parentNetworkId == NetworkId::None
             || objectsRelevance_[GetIndex(parentNetworkId)] != NetworkObjectRelevance::Irrelevant;
 
+        // Object entering or leaving interest area is checked immediately
+        const unsigned char interestFlags = objectsInterestFlags_[index];
+        const bool isInInterestArea = !hasInterestArea_ || (interestFlags & IsInInterestArea);
+        const bool hasInterestChanged = hasInterestArea_
+            && !(interestFlags & WasInInterestArea) != !(interestFlags & IsInInterestArea);
+
         if (!wasRelevant && isParentRelevant)
         {
+            // Irrelevant objects outside of interest area are checked only periodically
+            if (!isInInterestArea && !hasInterestChanged)
+            {
+                objectsRelevanceTimeouts_[index] -= timeStep;
+                if (objectsRelevanceTimeouts_[index] >= 0.0f)
+                    continue;
+            }
+
             // Begin replication of the object if both the object and its parent are relevant
-            objectsRelevance_[index] =
+            const NetworkObjectRelevance relevance =
                 networkObject->GetRelevanceForClient(connection_).value_or(NetworkObjectRelevance::NormalUpdates);
+
+            if (relevance != NetworkObjectRelevance::Irrelevant && snapshotBudget != 0)
+            {
+                // Defer replication if over budget, the object is checked again in the next frame
+                const float estimatedSize = sharedState.GetEstimatedSnapshotSize(index) * snapshotCompressionRatio;
+                if (numSnapshots > 0 && snapshotBytes + estimatedSize > snapshotBudget)
+                {
+                    objectsRelevanceTimeouts_[index] = 0.0f;
+                    ++snapshotStats_.numSnapshotsPending_;
+                    continue;
+                }
+                snapshotBytes += estimatedSize;
+            }
+
+            objectsRelevance_[index] = relevance;
+            objectsRelevanceTimeouts_[index] = relevanceTimeout;
             if (objectsRelevance_[index] != NetworkObjectRelevance::Irrelevant)
             {
-                objectsRelevanceTimeouts_[index] = relevanceTimeout;
+                ++numSnapshots;
+                ResetBaseline(index, GetCurrentFrame());
+                objectsPriority_[index] = 0.0f;
                 pendingUpdatedObjects_.push_back({networkObject, true});
             }
         }
@@ -582,7 +1053,7 @@ void ClientReplicationState::UpdateNetworkObjects(SharedReplicationState& shared
         {
             // If replicating, check periodically (abort replication immediately if parent is removed)
             objectsRelevanceTimeouts_[index] -= timeStep;
-            if (objectsRelevanceTimeouts_[index] < 0.0f || !isParentRelevant)
+            if (objectsRelevanceTimeouts_[index] < 0.0f || hasInterestChanged || !isParentRelevant)
             {
                 objectsRelevance_[index] = isParentRelevant
                     ? networkObject->GetRelevanceForClient(connection_).value_or(NetworkObjectRelevance::NormalUpdates)
@@ -591,6 +1062,7 @@ void ClientReplicationState::UpdateNetworkObjects(SharedReplicationState& shared
                 if (objectsRelevance_[index] == NetworkObjectRelevance::Irrelevant)
                 {
                     // Remove irrelevant component
+                    ResetBaseline(index, GetCurrentFrame());
                     pendingRemovedObjects_.push_back(networkId);
                     continue;
                 }
@@ -599,24 +1071,83 @@ void ClientReplicationState::UpdateNetworkObjects(SharedReplicationState& shared
             }
 
             // Queue non-snapshot update
-            sharedState.QueueDeltaUpdate(networkObject);
             pendingUpdatedObjects_.push_back({networkObject, false});
         }
     }
 }
 
+void ClientReplicationState::UpdateInterestArea(const SharedReplicationState& sharedState)
+{
+    // Forget previous frame, indices may be out of range if objects were removed
+    const unsigned numObjects = objectsInterestFlags_.size();
+    for (unsigned index : previousInterestAreaObjects_)
+    {
+        if (index < numObjects)
+            objectsInterestFlags_[index] &= ~WasInInterestArea;
+    }
+    for (unsigned index : currentInterestAreaObjects_)
+    {
+        if (index < numObjects)
+            objectsInterestFlags_[index] = WasInInterestArea;
+    }
+    ea::swap(previousInterestAreaObjects_, currentInterestAreaObjects_);
+    currentInterestAreaObjects_.clear();
+
+    hasInterestArea_ = objectRegistry_->HasSpatialIndex();
+    if (!hasInterestArea_)
+        return;
+
+    // Query objects around all objects owned by the client
+    const float interestRadius = GetSetting(NetworkSettings::InterestRadius).GetFloat();
+    for (NetworkObject* ownedObject : sharedState.GetOwnedObjectsByConnection(connection_))
+    {
+        interestQueryResult_.clear();
+        objectRegistry_->QueryNetworkObjectsInRadius(
+            ownedObject->GetNode()->GetWorldPosition(), interestRadius, interestQueryResult_);
+
+        for (NetworkObject* networkObject : interestQueryResult_)
+        {
+            const unsigned index = GetIndex(networkObject->GetNetworkId());
+            if (!(objectsInterestFlags_[index] & IsInInterestArea))
+            {
+                objectsInterestFlags_[index] |= IsInInterestArea;
+                currentInterestAreaObjects_.push_back(index);
+            }
+        }
+    }
+}
+
+void ClientReplicationState::QueueUpdates(SharedReplicationState& sharedState) const
+{
+    if (!IsSynchronized())
+        return;
+
+    for (const auto& [networkObject, isSnapshot] : pendingUpdatedObjects_)
+    {
+        if (isSnapshot)
+            sharedState.QueueSnapshot(networkObject);
+        else
+            sharedState.QueueDeltaUpdate(networkObject);
+    }
+}
+
 ServerReplicator::ServerReplicator(Scene* scene)
     : Object(scene->GetContext())
     , network_(GetSubsystem<Network>())
+    , workQueue_(GetSubsystem<WorkQueue>())
     , scene_(scene)
     , objectRegistry_(scene->GetComponent<ReplicationManager>())
     , updateFrequency_(network_->GetUpdateFps())
     , physicsSync_(scene_, updateFrequency_, true)
-    , sharedState_(MakeShared<SharedReplicationState>(objectRegistry_))
 {
     SetDefaultNetworkSetting(settings_, NetworkSettings::InternalProtocolVersion);
     SetNetworkSetting(settings_, NetworkSettings::UpdateFrequency, updateFrequency_);
 
+    const unsigned deltaCompressionHistory = GetSetting(NetworkSettings::DeltaCompressionHistory).GetUInt();
+    const unsigned snapshotDictionarySize = GetSetting(NetworkSettings::SnapshotDictionarySize).GetUInt();
+    sharedState_ = MakeShared<SharedReplicationState>(
+        objectRegistry_, workQueue_, deltaCompressionHistory, snapshotDictionarySize);
+
     SubscribeToEvent(E_INPUTREADY,
         [this](VariantMap& eventData)
     {
@@ -670,13 +1201,36 @@ void ServerReplicator::OnNetworkUpdate()
     eventData[P_FRAME] = static_cast<long long>(currentFrame_);
     network_->SendEvent(E_ENDSERVERNETWORKFRAME, eventData);
 
-    sharedState_->PrepareForUpdate();
+    clientStates_.clear();
+    bool isTrafficBreakdownEnabled = false;
     for (auto& [connection, clientState] : connections_)
-        clientState->UpdateNetworkObjects(*sharedState_);
+    {
+        clientStates_.push_back(clientState);
+        isTrafficBreakdownEnabled = isTrafficBreakdownEnabled || connection->IsTrafficStatisticsEnabled();
+    }
+    sharedState_->SetTrafficBreakdownEnabled(isTrafficBreakdownEnabled);
+
+    // Relevance is evaluated and messages are serialized for each client independently, only sending is serialized
+    sharedState_->PrepareForUpdate();
+    objectRegistry_->UpdateSpatialIndex(GetSetting(NetworkSettings::InterestCellSize).GetFloat());
+    ForEachParallel(workQueue_, clientStates_,
+        [&](unsigned, ClientReplicationState* clientState) { clientState->UpdateNetworkObjects(*sharedState_); });
+
+    for (ClientReplicationState* clientState : clientStates_)
+        clientState->QueueUpdates(*sharedState_);
     sharedState_->CookDeltaUpdates(currentFrame_);
 
+    ForEachParallel(workQueue_, clientStates_,
+        [&](unsigned, ClientReplicationState* clientState) { clientState->PrepareMessages(currentFrame_, *sharedState_); });
+
+    for (ClientReplicationState* clientState : clientStates_)
+        clientState->SendMessages();
+
     for (auto& [connection, clientState] : connections_)
-        clientState->SendMessages(currentFrame_, *sharedState_);
+    {
+        if (NetworkStatistics* statistics = connection->GetTrafficStatistics())
+            statistics->EndFrame(1.0f / GetUpdateFrequency());
+    }
 }
 
 void ServerReplicator::AddConnection(AbstractConnection* connection)
@@ -740,6 +1294,23 @@ void ServerReplicator::SetCurrentFrame(NetworkFrame frame)
     currentFrame_ = frame;
 }
 
+void ServerReplicator::SetSetting(const NetworkSetting& setting, const Variant& value)
+{
+    SetNetworkSetting(settings_, setting, value);
+}
+
+ClientPriorityStats ServerReplicator::GetPriorityStats(AbstractConnection* connection) const
+{
+    const ClientReplicationState* clientState = GetClientState(connection);
+    return clientState ? clientState->GetPriorityStats() : ClientPriorityStats{};
+}
+
+ClientSnapshotStats ServerReplicator::GetSnapshotStats(AbstractConnection* connection) const
+{
+    const ClientReplicationState* clientState = GetClientState(connection);
+    return clientState ? clientState->GetSnapshotStats() : ClientSnapshotStats{};
+}
+
 ClientReplicationState* ServerReplicator::GetClientState(AbstractConnection* connection) const
 {
     auto iter = connections_.find(connection);
@@ -755,9 +1326,11 @@ ea::string ServerReplicator::GetDebugInfo() const
 
     for (const auto& [connection, clientState] : connections_)
     {
-        result += Format("Connection {}: Ping {}ms, InDelay {}+{} frames, InLoss {}%\n", connection->ToString(),
-            connection->GetPing(), clientState->GetInputDelay(), clientState->GetInputBufferSize(),
-            CeilToInt(clientState->GetReportedInputLoss() * 100.0f));
+        const ClientPriorityStats& priorityStats = clientState->GetPriorityStats();
+        result += Format("Connection {}: Ping {}ms, InDelay {}+{} frames, InLoss {}%, Updates {}+{} deferred ({} bytes)\n",
+            connection->ToString(), connection->GetPing(), clientState->GetInputDelay(),
+            clientState->GetInputBufferSize(), CeilToInt(clientState->GetReportedInputLoss() * 100.0f),
+            priorityStats.numUpdatesSent_, priorityStats.numUpdatesDeferred_, priorityStats.numBytesSent_);
     }
 
     return result;
@@ -28,6 +28,7 @@
 #include "../Core/Timer.h"
 #include "../IO/MemoryBuffer.h"
 #include "../IO/VectorBuffer.h"
+#include "../Network/AbstractConnection.h"
 #include "../Network/ClockSynchronizer.h"
 #include "../Replica/ClientInputStatistics.h"
 #include "../Replica/NetworkId.h"
@@ -42,25 +43,38 @@
 namespace Urho3D
 {
 
-class AbstractConnection;
 class Network;
 class NetworkObject;
 class NetworkObjectRegistry;
 class Scene;
+class WorkQueue;
 struct NetworkSetting;
 
 /// Replication state shared between all clients.
+/// Const methods are safe to call from multiple threads between CookDeltaUpdates and next PrepareForUpdate.
 class SharedReplicationState : public RefCounted
 {
 public:
-    explicit SharedReplicationState(NetworkObjectRegistry* objectRegistry);
+    /// Number of objects cooked by single task.
+    static constexpr unsigned CookingBatchSize = 64;
+
+    /// Snapshot size estimate used for objects that were never cooked.
+    static constexpr unsigned DefaultSnapshotSizeEstimate = 64;
+
+    SharedReplicationState(NetworkObjectRegistry* objectRegistry, WorkQueue* workQueue, unsigned deltaCompressionHistory,
+        unsigned snapshotDictionarySize);
 
     /// Initial preparation for network update.
     void PrepareForUpdate();
     /// Request delta update to be prepared for specified object.
     void QueueDeltaUpdate(NetworkObject* networkObject);
-    /// Cook all requested delta updates.
+    /// Request snapshot to be prepared for specified object.
+    void QueueSnapshot(NetworkObject* networkObject);
+    /// Cook all requested delta updates and snapshots.
+    /// Objects are cooked in parallel on WorkQueue into per-thread buffers.
     void CookDeltaUpdates(NetworkFrame currentFrame);
+    /// Set whether to collect sizes of component data when cooking updates. Used for traffic statistics.
+    void SetTrafficBreakdownEnabled(bool enabled) { trafficBreakdownEnabled_ = enabled; }
 
     /// Return state of the current frame.
     /// @{
@@ -68,27 +82,55 @@ public:
     const ea::vector<NetworkObject*>& GetSortedObjects() const { return sortedNetworkObjects_; }
     unsigned GetIndexUpperBound() const;
     const ea::unordered_set<NetworkObject*>& GetOwnedObjectsByConnection(AbstractConnection* connection) const;
+    ConstByteSpan GetSnapshotByIndex(unsigned index) const;
     ea::optional<ConstByteSpan> GetReliableUpdateByIndex(unsigned index) const;
     ea::optional<ConstByteSpan> GetUnreliableUpdateByIndex(unsigned index) const;
+    ea::optional<ConstByteSpan> GetUnreliableUpdateByIndex(unsigned index, NetworkFrame frame) const;
+    unsigned GetDeltaCompressionHistory() const { return deltaCompressionHistory_; }
+    const ByteVector& GetSnapshotDictionary() const { return snapshotDictionary_; }
+    unsigned GetEstimatedSnapshotSize(unsigned index) const;
+    bool IsTrafficBreakdownEnabled() const { return trafficBreakdownEnabled_; }
+    const NetworkComponentTrafficVector& GetSnapshotTrafficByIndex(unsigned index) const;
+    const NetworkComponentTrafficVector& GetReliableTrafficByIndex(unsigned index) const;
+    const NetworkComponentTrafficVector& GetUnreliableTrafficByIndex(unsigned index) const;
     /// @}
 
 private:
     /// A span in delta update buffer corresponding to the update data of the individual NetworkObject.
+    /// Each thread writes into its own buffer, so span also stores index of the buffer.
     struct DeltaBufferSpan
     {
+        unsigned bufferIndex_{};
         unsigned beginOffset_{};
         unsigned endOffset_{};
     };
 
+    /// Unreliable delta updates cooked for the frame. Recent frames are kept as baselines for delta compression.
+    struct UnreliableFrameData
+    {
+        ea::optional<NetworkFrame> frame_;
+        ea::vector<VectorBuffer> buffers_;
+        ea::vector<bool> needUpdate_;
+        ea::vector<DeltaBufferSpan> spans_;
+    };
+
     void OnNetworkObjectAdded(NetworkObject* networkObject);
     void OnNetworkObjectRemoved(NetworkObject* networkObject);
 
     void ResetFrameBuffers();
     void InitializeNewObjects();
+    UnreliableFrameData& ResetUnreliableFrame(NetworkFrame frame);
+    void CookObject(NetworkFrame currentFrame, unsigned index, unsigned threadIndex, UnreliableFrameData& unreliableFrame);
+    void UpdateSnapshotDictionary();
 
     ConstByteSpan GetSpanData(const DeltaBufferSpan& span) const;
+    const NetworkComponentTrafficVector& GetTrafficByIndex(
+        const ea::vector<NetworkComponentTrafficVector>& traffic, unsigned index) const;
+    ea::optional<ConstByteSpan> GetUnreliableSpanData(const UnreliableFrameData& frameData, unsigned index) const;
 
     const WeakPtr<NetworkObjectRegistry> objectRegistry_{};
+    const WeakPtr<WorkQueue> workQueue_{};
+    const unsigned deltaCompressionHistory_{};
 
     ea::unordered_set<NetworkId> recentlyRemovedObjects_;
     ea::unordered_set<NetworkId> recentlyAddedObjects_;
@@ -96,14 +138,34 @@ private:
     ea::vector<NetworkObject*> sortedNetworkObjects_;
 
     ea::vector<bool> isDeltaUpdateQueued_;
+    ea::vector<bool> isSnapshotQueued_;
     ea::vector<bool> needReliableDeltaUpdate_;
-    ea::vector<bool> needUnreliableDeltaUpdate_;
 
-    VectorBuffer deltaUpdateBuffer_;
+    ea::vector<unsigned> cookingQueue_;
+    ea::vector<VectorBuffer> deltaUpdateBuffers_;
     ea::vector<DeltaBufferSpan> reliableDeltaUpdateData_;
-    ea::vector<DeltaBufferSpan> unreliableDeltaUpdateData_;
+    ea::vector<DeltaBufferSpan> snapshotData_;
+    ea::vector<unsigned> snapshotSizes_;
+
+    ea::vector<UnreliableFrameData> unreliableFrames_;
+    unsigned currentUnreliableFrame_{};
 
     ea::unordered_map<AbstractConnection*, ea::unordered_set<NetworkObject*>> ownedObjectsByConnection_;
+
+    /// Append-only dictionary for snapshot compression, contains one sample snapshot of each kind of object.
+    /// @{
+    const unsigned maxSnapshotDictionarySize_{};
+    ByteVector snapshotDictionary_;
+    ea::unordered_set<unsigned> snapshotDictionaryKeys_;
+    /// @}
+
+    /// Sizes of component data for the current frame, if enabled.
+    /// @{
+    bool trafficBreakdownEnabled_{};
+    ea::vector<NetworkComponentTrafficVector> snapshotTraffic_;
+    ea::vector<NetworkComponentTrafficVector> reliableTraffic_;
+    ea::vector<NetworkComponentTrafficVector> unreliableTraffic_;
+    /// @}
 };
 
 /// Clock synchronization state specific to individual client connection.
@@ -163,6 +225,32 @@ private:
     float clockTimeAccumulator_{};
 };
 
+/// Statistics of unreliable update prioritization for the client.
+struct ClientPriorityStats
+{
+    /// Number of objects sent in the latest frame.
+    unsigned numUpdatesSent_{};
+    /// Number of objects deferred in the latest frame due to bandwidth budget.
+    unsigned numUpdatesDeferred_{};
+    /// Size of unreliable update message in the latest frame.
+    unsigned numBytesSent_{};
+    /// Max accumulated priority in the latest frame.
+    float maxPriority_{};
+};
+
+/// Statistics of snapshots sent to the client when replication of NetworkObject-s begins.
+struct ClientSnapshotStats
+{
+    /// Number of objects deferred in the latest frame due to snapshot budget.
+    unsigned numSnapshotsPending_{};
+    /// Total number of snapshots sent.
+    unsigned numSnapshotsSent_{};
+    /// Total size of snapshot data before compression.
+    unsigned long long numRawBytes_{};
+    /// Total size of snapshot data after compression, including dictionary.
+    unsigned long long numCompressedBytes_{};
+};
+
 /// Scene replication state specific to individual client connection.
 struct ClientReplicationState : public ClientSynchronizationState
 {
@@ -171,12 +259,18 @@ public:
         NetworkObjectRegistry* objectRegistry, AbstractConnection* connection, const VariantMap& settings);
 
     /// Perform network update from the perspective of this client connection.
-    void UpdateNetworkObjects(SharedReplicationState& sharedState);
+    /// Safe to call for different clients from multiple threads.
+    void UpdateNetworkObjects(const SharedReplicationState& sharedState);
+    /// Request updates needed by this client from shared state.
+    void QueueUpdates(SharedReplicationState& sharedState) const;
 
     /// Process messages for this client.
     bool ProcessMessage(NetworkMessageId messageId, MemoryBuffer& messageData);
+    /// Serialize messages for current frame without sending them.
+    /// Safe to call for different clients from multiple threads.
+    void PrepareMessages(NetworkFrame currentFrame, const SharedReplicationState& sharedState);
     /// Send messages to connection for current frame.
-    void SendMessages(NetworkFrame currentFrame, const SharedReplicationState& sharedState);
+    void SendMessages();
 
     /// Manage reported input loss.
     /// @{
@@ -184,20 +278,76 @@ public:
     float GetReportedInputLoss() const { return reportedLoss_;}
     /// @}
 
+    const ClientPriorityStats& GetPriorityStats() const { return priorityStats_; }
+    const ClientSnapshotStats& GetSnapshotStats() const { return snapshotStats_; }
+
 private:
+    /// Indices of objects included into unreliable update of the frame.
+    struct SentUnreliableFrame
+    {
+        ea::optional<NetworkFrame> frame_;
+        ea::vector<unsigned> indices_;
+    };
+
     void ProcessObjectsFeedbackUnreliable(MemoryBuffer& messageData);
-    void SendRemoveObjects();
-    void SendAddObjects();
-    void SendUpdateObjectsReliable(const SharedReplicationState& sharedState);
-    void SendUpdateObjectsUnreliable(NetworkFrame currentFrame, const SharedReplicationState& sharedState);
+    void ProcessUpdateObjectsAck(const MsgUpdateObjectsAck& msg);
+    void AcknowledgeFrame(NetworkFrame frame);
+    void ResetBaseline(unsigned index, NetworkFrame currentFrame);
+    void UpdateInterestArea(const SharedReplicationState& sharedState);
+    void PrepareRemoveObjects();
+    void PrepareAddObjects(const SharedReplicationState& sharedState);
+    void PrepareUpdateObjectsReliable(const SharedReplicationState& sharedState);
+    void PrepareUpdateObjectsUnreliable(NetworkFrame currentFrame, const SharedReplicationState& sharedState);
+    void SortUnreliableUpdatesByPriority(const SharedReplicationState& sharedState);
+
+    /// Message serialized in advance and waiting to be sent.
+    struct PreparedMessage
+    {
+        NetworkMessageId messageId_{};
+        PacketType packetType_{};
+        VectorBuffer data_;
+        ea::string debugInfo_;
+    };
+
+    /// Serialize message same way as AbstractConnection::SendGeneratedMessage does.
+    template <class T> void PrepareGeneratedMessage(NetworkMessageId messageId, PacketType packetType, T generator);
+
+    /// Flags of the object location relative to the interest area of the client.
+    enum InterestFlag : unsigned char
+    {
+        WasInInterestArea = 1 << 0,
+        IsInInterestArea = 1 << 1,
+    };
 
     ea::vector<NetworkObjectRelevance> objectsRelevance_;
     ea::vector<float> objectsRelevanceTimeouts_;
+    ea::vector<unsigned char> objectsInterestFlags_;
+    ea::vector<float> objectsPriority_;
+    ea::vector<ea::optional<NetworkFrame>> objectsBaselineFrames_;
+    ea::vector<NetworkFrame> objectsSnapshotFrames_;
+
+    ea::vector<SentUnreliableFrame> sentUnreliableFrames_;
+
+    bool hasInterestArea_{};
+    ea::vector<unsigned> previousInterestAreaObjects_;
+    ea::vector<unsigned> currentInterestAreaObjects_;
+    ea::vector<NetworkObject*> interestQueryResult_;
 
     ea::vector<NetworkId> pendingRemovedObjects_;
     ea::vector<ea::pair<NetworkObject*, bool>> pendingUpdatedObjects_;
+    ea::vector<NetworkObject*> unreliableUpdateQueue_;
+    ClientPriorityStats priorityStats_;
+
+    unsigned sentSnapshotDictionarySize_{};
+    ClientSnapshotStats snapshotStats_;
+    VectorBuffer snapshotBuffer_;
+    ByteVector compressedSnapshotBuffer_;
 
     VectorBuffer componentBuffer_;
+    VectorBuffer deltaBuffer_;
+
+    ea::vector<PreparedMessage> preparedMessages_;
+    unsigned numPreparedMessages_{};
 
     float reportedLoss_{};
 };
@@ -218,12 +368,16 @@ public:
     void ReportInputLoss(AbstractConnection* connection, float percentLoss);
 
     void SetCurrentFrame(NetworkFrame frame);
+    /// Set network setting. Settings are copied on connection, so only new connections are affected.
+    void SetSetting(const NetworkSetting& setting, const Variant& value);
 
     /// Return current state of the replicator.
     /// @{
     ea::string GetDebugInfo() const;
     const Variant& GetSetting(const NetworkSetting& setting) const;
     unsigned GetFeedbackDelay(AbstractConnection* connection) const;
+    ClientPriorityStats GetPriorityStats(AbstractConnection* connection) const;
+    ClientSnapshotStats GetSnapshotStats(AbstractConnection* connection) const;
     const ea::unordered_set<NetworkObject*>& GetNetworkObjectsOwnedByConnection(AbstractConnection* connection) const;
     NetworkObject* GetNetworkObjectOwnedByConnection(AbstractConnection* connection) const;
     NetworkTime GetServerTime() const { return NetworkTime{currentFrame_}; }
@@ -238,6 +392,7 @@ private:
     ClientReplicationState* GetClientState(AbstractConnection* connection) const;
 
     const WeakPtr<Network> network_;
+    const WeakPtr<WorkQueue> workQueue_;
     const WeakPtr<Scene> scene_;
     const WeakPtr<NetworkObjectRegistry> objectRegistry_;
 
@@ -250,6 +405,7 @@ private:
 
     SharedPtr<SharedReplicationState> sharedState_;
     ea::unordered_map<AbstractConnection*, SharedPtr<ClientReplicationState>> connections_;
+    ea::vector<ClientReplicationState*> clientStates_;
 };
 
 }
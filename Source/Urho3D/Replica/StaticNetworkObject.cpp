@@ -41,6 +41,8 @@ void StaticNetworkObject::RegisterObject(Context* context)
 {
     context->AddFactoryReflection<StaticNetworkObject>(Category_Network);
 
+    URHO3D_COPY_BASE_ATTRIBUTES(NetworkObject);
+
     URHO3D_ACCESSOR_ATTRIBUTE("Client Prefab", GetClientPrefabAttr, SetClientPrefabAttr, ResourceRef, ResourceRef(PrefabResource::GetTypeStatic()), AM_DEFAULT);
 }
 
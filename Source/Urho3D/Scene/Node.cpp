@@ -698,8 +698,14 @@ void Node::SetWorldScale(const Vector3& scale)
 
 void Node::SetWorldTransform(const Vector3& position, const Quaternion& rotation)
 {
-    SetWorldPosition(position);
-    SetWorldRotation(rotation);
+    // Convert to parent space at once to mark node dirty only once
+    if (IsTransformHierarchyRoot())
+        SetTransform(position, rotation);
+    else
+    {
+        const Quaternion parentRotationInverse = parent_->GetWorldRotation().Inverse();
+        SetTransform(parent_->GetWorldTransform().Inverse() * position, parentRotationInverse * rotation);
+    }
 }
 
 void Node::SetWorldTransform(const Vector3& position, const Quaternion& rotation, float scale)
@@ -33,6 +33,9 @@
 #include "../Graphics/GraphicsEvents.h"
 #include "../Graphics/Renderer.h"
 #include "../IO/Log.h"
+#ifdef URHO3D_NETWORK
+#include "../Network/Network.h"
+#endif
 #include "../SystemUI/SystemUI.h"
 #include "../UI/UI.h"
 
@@ -192,6 +195,22 @@ void DebugHud::RenderUI(DebugHudModeFlags mode)
         }
     }
 
+#ifdef URHO3D_NETWORK
+    Network* network = GetSubsystem<Network>();
+    if ((mode & DEBUGHUD_SHOW_NETWORK) && network && network->IsTrafficStatisticsEnabled())
+    {
+        const NetworkStatistics stats = network->GetTrafficStatistics();
+        const ea::string text = stats.ToString();
+
+        const float left_offset = ui::GetCursorPos().x;
+        for (const ea::string& line : text.split('\n'))
+        {
+            ui::TextUnformatted(line.c_str());
+            ui::SetCursorPosX(left_offset);
+        }
+    }
+#endif
+
     if (mode & DEBUGHUD_SHOW_MODE)
     {
         const ImGuiStyle& style = ui::GetStyle();